@@ -11,12 +11,21 @@ NUM_TOTAL=0
 for f in `ls tests/*.til` ; do
   ((++NUM_TOTAL))
   echo -n -e "$f:\t"
-  rm -f test.asm test.o test.out test
-  if ! ./107/til -o test.asm $f &> /dev/null ; then
+  rm -f test.asm test.o test.out test til-profile.out
+  OUT=`basename -s .til $f`
+  OPTIONS=
+  if [ -f tests/options/$OUT.opt ] ; then
+    OPTIONS=`cat tests/options/$OUT.opt`
+  fi
+  if ! ./107/til $OPTIONS -o test.asm $f &> /dev/null ; then
     echo "FAILED CODEGEN"
     continue
   fi
-  if ! yasm -felf32 test.asm &> /dev/null ; then
+  ASM_OPTIONS=
+  if [[ " $OPTIONS " == *" -g "* ]] ; then
+    ASM_OPTIONS="-g dwarf2" # line tables from the %line directives
+  fi
+  if ! yasm -felf32 $ASM_OPTIONS test.asm &> /dev/null ; then
     echo "FAILED ASSEMBLY"
     continue
   fi
@@ -24,14 +33,21 @@ for f in `ls tests/*.til` ; do
     echo "FAILED LINKER"
     continue
   fi
-  if ! ./test &> test.out ; then
+  INPUT=/dev/null
+  if [ -f tests/input/$OUT.in ] ; then
+    INPUT=tests/input/$OUT.in
+  fi
+  if ! ./test < $INPUT &> test.out ; then
     echo "FAILED EXECUTION"
     continue
   fi
+  if [[ "$OPTIONS" == *profile* ]] && [ ! -s til-profile.out ] ; then
+    echo "FAILED PROFILE"
+    continue
+  fi
 
   tr -d '\n\v\t ' < test.out > test.clean
   printf "\n" >> test.clean
-  OUT=`basename -s .til $f`
   if ! diff -q test.out tests/expected/$OUT.out &> /dev/null ; then
     echo "FAILED OUTPUT"
     diff -u test.out tests/expected/$OUT.out
@@ -0,0 +1,115 @@
+#!/bin/bash
+#
+# Build a program made of several TIL units, recompiling only what changed.
+#
+# usage: ./til-build.sh program unit.til...
+#
+# Each unit's interface (the forward declarations of its public symbols) is
+# kept in build/<unit>.tili and placed before the other units when they are
+# compiled. An interface file is only rewritten when its contents change, so
+# changing the body of a function does not recompile the units that use it.
+# Everything is rebuilt when the compiler changes. Units are independent of
+# each other within each step, so up to JOBS of them are processed at the
+# same time.
+
+TIL=${TIL:-./til/til}
+BUILD=${BUILD:-build}
+JOBS=${JOBS:-`nproc`}
+COMPILER=`which ${TIL%% *} || echo ${TIL%% *}` # TIL may carry options
+
+if [ $# -lt 2 ] ; then
+  echo "usage: $0 program unit.til..."
+  exit 1
+fi
+PROGRAM=$1
+shift
+
+mkdir -p $BUILD
+
+FAILED=
+
+# run a step in the background, keeping at most JOBS of them running
+spawn() {
+  while [ `jobs -rp | wc -l` -ge $JOBS ] ; do
+    wait -n || FAILED=yes
+  done
+  "$@" &
+}
+
+# wait for all the steps, stopping if any of them failed
+finish() {
+  while [ -n "`jobs -p`" ] ; do
+    wait -n || FAILED=yes
+  done
+  if [ -n "$FAILED" ] ; then
+    exit 1
+  fi
+}
+
+interface() {
+  local u=$BUILD/`basename -s .til $1`
+  $TIL --target tili -o $u.tili.new $1 || return 1
+  if cmp -s $u.tili.new $u.tili ; then
+    rm -f $u.tili.new
+  else
+    mv $u.tili.new $u.tili
+  fi
+  touch $u.stamp
+}
+
+compile() {
+  local f=$1
+  local u=$BUILD/`basename -s .til $f`
+  shift
+  echo "compiling $f"
+  # the interfaces share the source's first line, so that diagnostics and
+  # %line directives (with -g) keep its line numbers; they also name it
+  (cat "$@" | tr '\n' ' ' ; cat $f) > $u.til
+  $TIL -o $u.asm $u.til 2>&1 | sed "s|$u.til|$f|g" >&2
+  if [ ${PIPESTATUS[0]} -ne 0 ] ; then
+    return 1
+  fi
+  sed -i "s|^\(%line .*\) $u.til\$|\1 $f|" $u.asm
+  yasm -felf32 -o $u.o $u.asm
+}
+
+# interfaces
+for f in "$@" ; do
+  u=$BUILD/`basename -s .til $f`
+  if [ -e $u.stamp ] && [ ! $f -nt $u.stamp ] && [ ! $COMPILER -nt $u.stamp ] ; then
+    continue
+  fi
+  spawn interface $f
+done
+finish
+
+# objects
+OBJECTS=
+for f in "$@" ; do
+  u=$BUILD/`basename -s .til $f`
+  OBJECTS="$OBJECTS $u.o"
+  IMPORTS=
+  for g in "$@" ; do
+    if [ $g != $f ] ; then
+      IMPORTS="$IMPORTS $BUILD/`basename -s .til $g`.tili"
+    fi
+  done
+
+  STALE=
+  if [ ! -e $u.o ] || [ $f -nt $u.o ] || [ $COMPILER -nt $u.o ] ; then
+    STALE=yes
+  fi
+  for i in $IMPORTS ; do
+    if [ $i -nt $u.o ] ; then
+      STALE=yes
+    fi
+  done
+  if [ -z "$STALE" ] ; then
+    continue
+  fi
+
+  spawn compile $f $IMPORTS
+done
+finish
+
+ld -m elf_i386 -o $PROGRAM $OBJECTS -lrts -L$ROOT/usr/lib
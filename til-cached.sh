@@ -0,0 +1,67 @@
+#!/bin/bash
+#
+# Run the TIL compiler through a cache of its outputs.
+#
+# usage: ./til-cached.sh [til options] file.til
+#        ./til-cached.sh --stats
+#
+# Outputs are looked up by a hash of the source, the options and the
+# compiler itself (and the source's path with -g, which the output names).
+# Entries are written to a temporary file and then renamed, so concurrent
+# runs never see (or leave) a partial entry.
+
+TIL=${TIL:-./til/til}
+TIL_CACHE=${TIL_CACHE:-${XDG_CACHE_HOME:-$HOME/.cache}/til}
+
+mkdir -p $TIL_CACHE
+
+if [ "$1" = "--stats" ] ; then
+  HITS=`grep -c '^hit' $TIL_CACHE/log 2>/dev/null`
+  MISSES=`grep -c '^miss' $TIL_CACHE/log 2>/dev/null`
+  echo "hits: ${HITS:-0}"
+  echo "misses: ${MISSES:-0}"
+  echo "entries: `ls $TIL_CACHE | grep -c '\.out$'`"
+  echo "size: `du -sh $TIL_CACHE | cut -f1`"
+  exit 0
+fi
+
+SOURCE=
+OUTPUT=
+TARGET=asm
+OPTIONS=()
+while [ $# -gt 0 ] ; do
+  case "$1" in
+    -o) OUTPUT=$2 ; shift ;;
+    --target) TARGET=$2 ; OPTIONS+=("$1" "$2") ; shift ;;
+    *.til) SOURCE=$1 ;;
+    *) OPTIONS+=("$1") ;;
+  esac
+  shift
+done
+if [ -z "$SOURCE" ] ; then
+  echo "usage: $0 [til options] file.til"
+  exit 1
+fi
+if [ -z "$OUTPUT" ] ; then
+  OUTPUT=`basename -s .til $SOURCE`.$TARGET
+fi
+
+NAME=
+for OPTION in "${OPTIONS[@]}" ; do
+  case "$OPTION" in
+    -g|--debug) NAME=$SOURCE ;;
+  esac
+done
+KEY=`(cat $TIL $SOURCE ; echo "${OPTIONS[@]}" $NAME) | sha256sum | cut -d' ' -f1`
+ENTRY=$TIL_CACHE/$KEY.out
+
+if [ -e $ENTRY ] ; then
+  echo "hit $KEY" >> $TIL_CACHE/log
+  cp $ENTRY $OUTPUT
+  exit 0
+fi
+
+echo "miss $KEY" >> $TIL_CACHE/log
+$TIL "${OPTIONS[@]}" -o $OUTPUT $SOURCE || exit 1
+TEMPORARY=`mktemp $TIL_CACHE/$KEY.XXXXXX`
+cp $OUTPUT $TEMPORARY && mv -f $TEMPORARY $ENTRY
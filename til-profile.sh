@@ -0,0 +1,36 @@
+#!/bin/bash
+#
+# Print the flat profile written by a program compiled with --target profile.
+#
+# usage: ./til-profile.sh [til-profile.out]
+#
+# Each 64-byte record holds the calls of a function, its active calls, the
+# cycles spent in all its calls (recursion counted once) and in the function
+# itself (callees excluded), and its name. Functions never called are left out.
+
+PROFILE=${1:-til-profile.out}
+
+if [ ! -f "$PROFILE" ] ; then
+  echo "$0: $PROFILE: no such file" >&2
+  exit 1
+fi
+
+RECORDS=$(( `stat -c %s "$PROFILE"` / 64 ))
+ALL=0
+LINES=()
+for (( i = 0; i < RECORDS; i++ )) ; do
+  read CALLS ACTIVE TOTAL_LO TOTAL_HI SELF_LO SELF_HI REST <<< `od -An -v -w24 -tu4 -j $(( i * 64 )) -N 24 "$PROFILE"`
+  [ "$CALLS" -eq 0 ] && continue
+  NAME=`dd if="$PROFILE" bs=1 skip=$(( i * 64 + 32 )) count=32 2>/dev/null | tr -d '\0'`
+  SELF=$(( SELF_HI * 4294967296 + SELF_LO ))
+  TOTAL=$(( TOTAL_HI * 4294967296 + TOTAL_LO ))
+  ALL=$(( ALL + SELF ))
+  LINES+=("$SELF $TOTAL $CALLS $NAME")
+done
+
+printf "%7s %16s %16s %12s  %s\n" "% self" "self cycles" "total cycles" "calls" "name"
+for LINE in "${LINES[@]}" ; do
+  echo "$LINE"
+done | sort -k1,1nr | while read SELF TOTAL CALLS NAME ; do
+  printf "%7s %16d %16d %12d  %s\n" `awk "BEGIN { printf \"%.2f\", ${ALL} ? 100 * $SELF / $ALL : 0 }"` $SELF $TOTAL $CALLS "$NAME"
+done
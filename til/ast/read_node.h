@@ -8,12 +8,16 @@ namespace til {
 
   /**
    * Class for describing read nodes.
+   * With a count, reads that many values into a new vector.
    */
   class read_node : public cdk::expression_node {
+    cdk::expression_node *_count;
 
   public:
-    read_node(int lineno) :
-        cdk::expression_node(lineno) {}
+    read_node(int lineno, cdk::expression_node *count = nullptr) :
+        cdk::expression_node(lineno), _count(count) {}
+
+    cdk::expression_node *count() { return _count; }
 
     void accept(basic_ast_visitor *sp, int level) { sp->do_read_node(this, level); }
 
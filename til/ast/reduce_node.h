@@ -0,0 +1,43 @@
+#ifndef __TIL_AST_REDUCE_NODE_H__
+#define __TIL_AST_REDUCE_NODE_H__
+
+#include <cdk/ast/expression_node.h>
+
+namespace til {
+
+  class reduce_node: public cdk::expression_node {
+    cdk::expression_node *_vector, *_low, *_high, *_function, *_initial;
+
+  public:
+    reduce_node(int lineno, cdk::expression_node *vector, cdk::expression_node *low, cdk::expression_node *high,
+                cdk::expression_node *function, cdk::expression_node *initial) :
+        cdk::expression_node(lineno), _vector(vector), _low(low), _high(high), _function(function), _initial(initial) {
+    }
+
+  public:
+    cdk::expression_node* vector() {
+      return _vector;
+    }
+    cdk::expression_node* low() {
+      return _low;
+    }
+    cdk::expression_node* high() {
+      return _high;
+    }
+    cdk::expression_node* function() {
+      return _function;
+    }
+    cdk::expression_node* initial() {
+      return _initial;
+    }
+
+  public:
+    void accept(basic_ast_visitor *sp, int level) {
+      sp->do_reduce_node(this, level);
+    }
+
+  };
+
+} // til
+
+#endif
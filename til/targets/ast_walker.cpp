@@ -0,0 +1,212 @@
+#include <string>
+#include "targets/ast_walker.h"
+#include ".auto/all_nodes.h"  // automatically generated
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_nil_node(cdk::nil_node *const node, int lvl) {
+  // EMPTY
+}
+void til::ast_walker::do_data_node(cdk::data_node *const node, int lvl) {
+  // EMPTY
+}
+
+void til::ast_walker::do_sequence_node(cdk::sequence_node *const node, int lvl) {
+  for (size_t i = 0; i < node->size(); i++) {
+    node->node(i)->accept(this, lvl);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_integer_node(cdk::integer_node *const node, int lvl) {
+  // EMPTY
+}
+void til::ast_walker::do_double_node(cdk::double_node *const node, int lvl) {
+  // EMPTY
+}
+void til::ast_walker::do_string_node(cdk::string_node *const node, int lvl) {
+  // EMPTY
+}
+void til::ast_walker::do_null_node(til::null_node *const node, int lvl) {
+  // EMPTY
+}
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_unary_operation(cdk::unary_operation_node *const node, int lvl) {
+  node->argument()->accept(this, lvl);
+}
+
+void til::ast_walker::do_unary_minus_node(cdk::unary_minus_node *const node, int lvl) {
+  do_unary_operation(node, lvl);
+}
+void til::ast_walker::do_unary_plus_node(cdk::unary_plus_node *const node, int lvl) {
+  do_unary_operation(node, lvl);
+}
+void til::ast_walker::do_not_node(cdk::not_node *const node, int lvl) {
+  do_unary_operation(node, lvl);
+}
+void til::ast_walker::do_objects_node(til::objects_node *const node, int lvl) {
+  do_unary_operation(node, lvl);
+}
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_binary_operation(cdk::binary_operation_node *const node, int lvl) {
+  node->left()->accept(this, lvl);
+  node->right()->accept(this, lvl);
+}
+
+void til::ast_walker::do_add_node(cdk::add_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_sub_node(cdk::sub_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_mul_node(cdk::mul_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_div_node(cdk::div_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_mod_node(cdk::mod_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_lt_node(cdk::lt_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_le_node(cdk::le_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_ge_node(cdk::ge_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_gt_node(cdk::gt_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_ne_node(cdk::ne_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_eq_node(cdk::eq_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_and_node(cdk::and_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+void til::ast_walker::do_or_node(cdk::or_node *const node, int lvl) {
+  do_binary_operation(node, lvl);
+}
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_variable_node(cdk::variable_node *const node, int lvl) {
+  // EMPTY
+}
+void til::ast_walker::do_index_node(til::index_node *const node, int lvl) {
+  node->base()->accept(this, lvl);
+  node->index()->accept(this, lvl);
+}
+void til::ast_walker::do_rvalue_node(cdk::rvalue_node *const node, int lvl) {
+  node->lvalue()->accept(this, lvl);
+}
+void til::ast_walker::do_address_of_node(til::address_of_node *const node, int lvl) {
+  node->lvalue()->accept(this, lvl);
+}
+void til::ast_walker::do_sizeof_node(til::sizeof_node *const node, int lvl) {
+  node->expression()->accept(this, lvl);
+}
+void til::ast_walker::do_assignment_node(cdk::assignment_node *const node, int lvl) {
+  node->rvalue()->accept(this, lvl);
+  node->lvalue()->accept(this, lvl);
+}
+void til::ast_walker::do_read_node(til::read_node *const node, int lvl) {
+  if (node->count()) node->count()->accept(this, lvl);
+}
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_function_call_node(til::function_call_node *const node, int lvl) {
+  node->arguments()->accept(this, lvl);
+  if (node->func()) node->func()->accept(this, lvl);
+}
+void til::ast_walker::do_function_definition_node(til::function_definition_node *const node, int lvl) {
+  node->arguments()->accept(this, lvl + 2);
+  node->block()->accept(this, lvl + 2);
+}
+void til::ast_walker::do_declaration_node(til::declaration_node *const node, int lvl) {
+  if (node->initializer()) node->initializer()->accept(this, lvl);
+}
+void til::ast_walker::do_block_node(til::block_node *const node, int lvl) {
+  node->declarations()->accept(this, lvl + 2);
+  node->instructions()->accept(this, lvl + 2);
+}
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_evaluation_node(til::evaluation_node *const node, int lvl) {
+  node->argument()->accept(this, lvl);
+}
+void til::ast_walker::do_print_node(til::print_node *const node, int lvl) {
+  node->expressions()->accept(this, lvl);
+}
+void til::ast_walker::do_return_node(til::return_node *const node, int lvl) {
+  if (node->retval()) node->retval()->accept(this, lvl);
+}
+void til::ast_walker::do_next_node(til::next_node *const node, int lvl) {
+  // EMPTY
+}
+void til::ast_walker::do_stop_node(til::stop_node *const node, int lvl) {
+  // EMPTY
+}
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_if_node(til::if_node *const node, int lvl) {
+  node->condition()->accept(this, lvl);
+  node->block()->accept(this, lvl + 2);
+}
+void til::ast_walker::do_if_else_node(til::if_else_node *const node, int lvl) {
+  node->condition()->accept(this, lvl);
+  node->thenblock()->accept(this, lvl + 2);
+  if (node->elseblock()) node->elseblock()->accept(this, lvl + 2);
+}
+void til::ast_walker::do_loop_node(til::loop_node *const node, int lvl) {
+  node->condition()->accept(this, lvl);
+  node->instruction()->accept(this, lvl + 2);
+}
+
+//---------------------------------------------------------------------------
+
+void til::ast_walker::do_with_node(til::with_node *const node, int lvl) {
+  node->function()->accept(this, lvl);
+  node->vector()->accept(this, lvl);
+  node->low()->accept(this, lvl);
+  node->high()->accept(this, lvl);
+}
+void til::ast_walker::do_unless_node(til::unless_node *const node, int lvl) {
+  node->condition()->accept(this, lvl);
+  node->vector()->accept(this, lvl);
+  node->count()->accept(this, lvl);
+  node->function()->accept(this, lvl);
+}
+void til::ast_walker::do_sweep_node(til::sweep_node *const node, int lvl) {
+  node->vector()->accept(this, lvl);
+  node->low()->accept(this, lvl);
+  node->high()->accept(this, lvl);
+  node->function()->accept(this, lvl);
+  node->condition()->accept(this, lvl);
+}
+void til::ast_walker::do_iterate_node(til::iterate_node *const node, int lvl) {
+  node->vector()->accept(this, lvl);
+  node->count()->accept(this, lvl);
+  node->function()->accept(this, lvl);
+  node->condition()->accept(this, lvl);
+}
+void til::ast_walker::do_reduce_node(til::reduce_node *const node, int lvl) {
+  node->vector()->accept(this, lvl);
+  node->low()->accept(this, lvl);
+  node->high()->accept(this, lvl);
+  node->function()->accept(this, lvl);
+  node->initial()->accept(this, lvl);
+}
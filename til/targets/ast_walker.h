@@ -0,0 +1,37 @@
+#ifndef __TIL_TARGETS_AST_WALKER_H__
+#define __TIL_TARGETS_AST_WALKER_H__
+
+#include "targets/basic_ast_visitor.h"
+
+namespace til {
+
+  //!
+  //! Visit every node of a syntax tree, in evaluation order, without
+  //! doing anything else. Analyses redefine only the nodes they care about.
+  //!
+  class ast_walker: public basic_ast_visitor {
+  public:
+    ast_walker(std::shared_ptr<cdk::compiler> compiler) :
+        basic_ast_visitor(compiler) {
+    }
+
+  public:
+    virtual ~ast_walker() {
+    }
+
+  protected:
+    virtual void do_unary_operation(cdk::unary_operation_node *const node, int lvl);
+    virtual void do_binary_operation(cdk::binary_operation_node *const node, int lvl);
+
+  public:
+  // do not edit these lines
+#define __IN_VISITOR_HEADER__
+#include ".auto/visitor_decls.h"       // automatically generated
+#undef __IN_VISITOR_HEADER__
+  // do not edit these lines: end
+
+  };
+
+} // til
+
+#endif
@@ -0,0 +1,4 @@
+#include "targets/check_target.h"
+
+/** @var create and register a target that only reports errors. */
+til::check_target til::check_target::_self;
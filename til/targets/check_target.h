@@ -0,0 +1,31 @@
+#ifndef __TIL_TARGETS_CHECK_TARGET_H__
+#define __TIL_TARGETS_CHECK_TARGET_H__
+
+#include <cdk/targets/basic_target.h>
+#include <cdk/ast/basic_node.h>
+#include "targets/diagnostics_checker.h"
+
+namespace til {
+
+  class check_target: public cdk::basic_target {
+    static check_target _self;
+
+  private:
+    check_target() :
+        cdk::basic_target("check") {
+    }
+
+  public:
+    bool evaluate(std::shared_ptr<cdk::compiler> compiler) {
+      cdk::symbol_table<til::symbol> symtab;
+
+      diagnostics_checker checker(compiler, symtab);
+      compiler->ast()->accept(&checker, 0);
+      return checker.errors() == 0;
+    }
+
+  };
+
+} // til
+
+#endif
@@ -0,0 +1,350 @@
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include "targets/constant_evaluator.h"
+#include ".auto/all_nodes.h"  // automatically generated
+
+// results wrap around as in the generated code
+static int wrap(int64_t value) {
+  return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+std::optional<int> til::constant_evaluator::call(til::function_definition_node *const function,
+                                                 const std::vector<int> &arguments) {
+  auto known = _results.find({ function, arguments });
+  if (known != _results.end()) return known->second;
+
+  _steps = 0;
+  try {
+    return invoke(function, arguments);
+  } catch (const not_typed &) {
+    reset(); // may be computed once the functions are generated
+    return std::nullopt;
+  } catch (const not_constant &) {
+    reset();
+    _results[{ function, arguments }] = std::nullopt;
+    return std::nullopt;
+  }
+}
+
+void til::constant_evaluator::reset() {
+  _scopes.clear();
+  _functions.clear();
+  _returning = false;
+  _stopping = _skipping = 0;
+}
+
+int til::constant_evaluator::invoke(til::function_definition_node *const function, const std::vector<int> &arguments) {
+  auto type = cdk::functional_type::cast(function->type());
+  if (!type || function->is_main() || !type->output(0) || type->output(0)->name() != cdk::TYPE_INT
+      || function->arguments()->size() != arguments.size()) {
+    throw not_constant();
+  }
+
+  auto known = _results.find({ function, arguments });
+  if (known != _results.end()) {
+    if (!known->second) throw not_constant();
+    return *known->second;
+  }
+  if (_functions.size() >= TIL_EVALUATION_DEPTH) throw not_constant();
+
+  std::map<std::string, int> parameters;
+  for (size_t i = 0; i < arguments.size(); i++) {
+    auto parameter = dynamic_cast<til::declaration_node*>(function->arguments()->node(i));
+    if (!parameter) throw not_constant();
+    if (!parameter->type()) throw not_typed();
+    if (parameter->type()->name() != cdk::TYPE_INT) throw not_constant();
+    parameters[parameter->identifier()] = arguments[i];
+  }
+
+  auto scopes = std::move(_scopes);
+  _scopes = { parameters };
+  _functions.push_back(function);
+
+  function->block()->accept(this, 0);
+  if (!_returning) throw not_constant(); // no value
+  _returning = false;
+
+  _functions.pop_back();
+  _scopes = std::move(scopes);
+  _results[{ function, arguments }] = _value;
+  return _value;
+}
+
+int til::constant_evaluator::evaluate(cdk::expression_node *const node) {
+  if (!node->type()) throw not_typed(); // not generated yet
+  if (!node->is_typed(cdk::TYPE_INT)) throw not_constant();
+  node->accept(this, 0);
+  return _value;
+}
+
+int &til::constant_evaluator::variable(cdk::lvalue_node *const lvalue) {
+  auto variable = dynamic_cast<cdk::variable_node*>(lvalue);
+  if (!variable) throw not_constant(); // memory
+  for (auto scope = _scopes.rbegin(); scope != _scopes.rend(); scope++) {
+    auto it = scope->find(variable->name());
+    if (it != scope->end()) return it->second;
+  }
+  throw not_constant(); // global
+}
+
+void til::constant_evaluator::step(cdk::basic_node *const node) {
+  if (++_steps > TIL_EVALUATION_STEPS) throw not_constant();
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_nil_node(cdk::nil_node *const node, int lvl) {
+  // EMPTY
+}
+void til::constant_evaluator::do_data_node(cdk::data_node *const node, int lvl) {
+  throw not_constant();
+}
+
+void til::constant_evaluator::do_sequence_node(cdk::sequence_node *const node, int lvl) {
+  for (size_t i = 0; i < node->size() && !interrupted(); i++) {
+    node->node(i)->accept(this, lvl);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_integer_node(cdk::integer_node *const node, int lvl) {
+  step(node);
+  _value = node->value();
+}
+void til::constant_evaluator::do_double_node(cdk::double_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_string_node(cdk::string_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_null_node(til::null_node *const node, int lvl) {
+  throw not_constant();
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_unary_minus_node(cdk::unary_minus_node *const node, int lvl) {
+  step(node);
+  _value = wrap(-static_cast<int64_t>(evaluate(node->argument())));
+}
+void til::constant_evaluator::do_unary_plus_node(cdk::unary_plus_node *const node, int lvl) {
+  step(node);
+  _value = evaluate(node->argument());
+}
+void til::constant_evaluator::do_not_node(cdk::not_node *const node, int lvl) {
+  step(node);
+  _value = evaluate(node->argument()) == 0;
+}
+void til::constant_evaluator::do_objects_node(til::objects_node *const node, int lvl) {
+  throw not_constant();
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_add_node(cdk::add_node *const node, int lvl) {
+  step(node);
+  if (!node->is_typed(cdk::TYPE_INT)) throw not_constant(); // pointer arithmetic
+  int64_t left = evaluate(node->left());
+  _value = wrap(left + evaluate(node->right()));
+}
+void til::constant_evaluator::do_sub_node(cdk::sub_node *const node, int lvl) {
+  step(node);
+  if (!node->is_typed(cdk::TYPE_INT)) throw not_constant();
+  int64_t left = evaluate(node->left());
+  _value = wrap(left - evaluate(node->right()));
+}
+void til::constant_evaluator::do_mul_node(cdk::mul_node *const node, int lvl) {
+  step(node);
+  int64_t left = evaluate(node->left());
+  _value = wrap(left * evaluate(node->right()));
+}
+void til::constant_evaluator::do_div_node(cdk::div_node *const node, int lvl) {
+  step(node);
+  int left = evaluate(node->left()), right = evaluate(node->right());
+  if (right == 0 || (left == INT32_MIN && right == -1)) throw not_constant(); // traps at run time
+  _value = left / right;
+}
+void til::constant_evaluator::do_mod_node(cdk::mod_node *const node, int lvl) {
+  step(node);
+  int left = evaluate(node->left()), right = evaluate(node->right());
+  if (right == 0 || (left == INT32_MIN && right == -1)) throw not_constant();
+  _value = left % right;
+}
+void til::constant_evaluator::do_lt_node(cdk::lt_node *const node, int lvl) {
+  step(node);
+  int left = evaluate(node->left());
+  _value = left < evaluate(node->right());
+}
+void til::constant_evaluator::do_le_node(cdk::le_node *const node, int lvl) {
+  step(node);
+  int left = evaluate(node->left());
+  _value = left <= evaluate(node->right());
+}
+void til::constant_evaluator::do_ge_node(cdk::ge_node *const node, int lvl) {
+  step(node);
+  int left = evaluate(node->left());
+  _value = left >= evaluate(node->right());
+}
+void til::constant_evaluator::do_gt_node(cdk::gt_node *const node, int lvl) {
+  step(node);
+  int left = evaluate(node->left());
+  _value = left > evaluate(node->right());
+}
+void til::constant_evaluator::do_ne_node(cdk::ne_node *const node, int lvl) {
+  step(node);
+  int left = evaluate(node->left());
+  _value = left != evaluate(node->right());
+}
+void til::constant_evaluator::do_eq_node(cdk::eq_node *const node, int lvl) {
+  step(node);
+  int left = evaluate(node->left());
+  _value = left == evaluate(node->right());
+}
+void til::constant_evaluator::do_and_node(cdk::and_node *const node, int lvl) {
+  step(node);
+  _value = evaluate(node->left()) && evaluate(node->right());
+}
+void til::constant_evaluator::do_or_node(cdk::or_node *const node, int lvl) {
+  step(node);
+  _value = evaluate(node->left()) || evaluate(node->right());
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_variable_node(cdk::variable_node *const node, int lvl) {
+  throw not_constant(); // only seen through rvalues and assignments
+}
+void til::constant_evaluator::do_index_node(til::index_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_rvalue_node(cdk::rvalue_node *const node, int lvl) {
+  step(node);
+  _value = variable(node->lvalue());
+}
+void til::constant_evaluator::do_address_of_node(til::address_of_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_sizeof_node(til::sizeof_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_assignment_node(cdk::assignment_node *const node, int lvl) {
+  step(node);
+  int value = evaluate(node->rvalue());
+  _value = variable(node->lvalue()) = value;
+}
+void til::constant_evaluator::do_read_node(til::read_node *const node, int lvl) {
+  throw not_constant();
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_function_call_node(til::function_call_node *const node, int lvl) {
+  step(node);
+  til::function_definition_node *function = nullptr;
+  if (!node->func()) {
+    function = _functions.back();
+  } else if (auto literal = dynamic_cast<til::function_definition_node*>(node->func())) {
+    function = literal;
+  } else if (auto rvalue = dynamic_cast<cdk::rvalue_node*>(node->func())) {
+    auto global = dynamic_cast<cdk::variable_node*>(rvalue->lvalue());
+    bool local = global && std::any_of(_scopes.begin(), _scopes.end(), [global](auto &scope) {
+      return scope.count(global->name()) > 0;
+    });
+    if (global && !local) function = _constants->literal(global->name());
+  }
+  if (!function) throw not_constant();
+
+  std::vector<int> arguments;
+  for (size_t i = 0; i < node->arguments()->size(); i++) {
+    arguments.push_back(evaluate(dynamic_cast<cdk::expression_node*>(node->arguments()->node(i))));
+  }
+  _value = invoke(function, arguments);
+}
+void til::constant_evaluator::do_function_definition_node(til::function_definition_node *const node, int lvl) {
+  throw not_constant(); // only called, never used as a value
+}
+void til::constant_evaluator::do_declaration_node(til::declaration_node *const node, int lvl) {
+  step(node);
+  if (!node->type()) throw not_typed();
+  if (node->type()->name() != cdk::TYPE_INT || !node->initializer()) throw not_constant();
+  _scopes.back()[node->identifier()] = evaluate(node->initializer());
+}
+void til::constant_evaluator::do_block_node(til::block_node *const node, int lvl) {
+  _scopes.emplace_back();
+  node->declarations()->accept(this, lvl);
+  if (!interrupted()) node->instructions()->accept(this, lvl);
+  _scopes.pop_back();
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_evaluation_node(til::evaluation_node *const node, int lvl) {
+  step(node);
+  if (!node->argument()->type()) throw not_typed();
+  node->argument()->accept(this, lvl);
+}
+void til::constant_evaluator::do_print_node(til::print_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_return_node(til::return_node *const node, int lvl) {
+  step(node);
+  if (!node->retval()) throw not_constant();
+  _value = evaluate(node->retval());
+  _returning = true;
+}
+void til::constant_evaluator::do_next_node(til::next_node *const node, int lvl) {
+  step(node);
+  _skipping = node->level();
+}
+void til::constant_evaluator::do_stop_node(til::stop_node *const node, int lvl) {
+  step(node);
+  _stopping = node->level();
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_if_node(til::if_node *const node, int lvl) {
+  step(node);
+  if (evaluate(node->condition())) node->block()->accept(this, lvl);
+}
+void til::constant_evaluator::do_if_else_node(til::if_else_node *const node, int lvl) {
+  step(node);
+  if (evaluate(node->condition())) {
+    node->thenblock()->accept(this, lvl);
+  } else {
+    node->elseblock()->accept(this, lvl);
+  }
+}
+void til::constant_evaluator::do_loop_node(til::loop_node *const node, int lvl) {
+  while (true) {
+    step(node);
+    if (!evaluate(node->condition())) break;
+    node->instruction()->accept(this, lvl);
+    if (_returning) break;
+    if (_stopping > 0) {
+      _stopping--;
+      break;
+    }
+    if (_skipping > 0 && --_skipping > 0) break; // restarts an outer loop
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_evaluator::do_with_node(til::with_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_unless_node(til::unless_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_sweep_node(til::sweep_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_iterate_node(til::iterate_node *const node, int lvl) {
+  throw not_constant();
+}
+void til::constant_evaluator::do_reduce_node(til::reduce_node *const node, int lvl) {
+  throw not_constant();
+}
@@ -0,0 +1,86 @@
+#ifndef __TIL_TARGETS_CONSTANT_EVALUATOR_H__
+#define __TIL_TARGETS_CONSTANT_EVALUATOR_H__
+
+#include "targets/basic_ast_visitor.h"
+#include "targets/constant_functions.h"
+
+#include <map>
+#include <optional>
+#include <vector>
+
+// nodes evaluated (at most) when computing a call at compile time
+#ifndef TIL_EVALUATION_STEPS
+#define TIL_EVALUATION_STEPS 1000000
+#endif
+
+// calls nested (at most) when computing a call at compile time
+#ifndef TIL_EVALUATION_DEPTH
+#define TIL_EVALUATION_DEPTH 1000
+#endif
+
+namespace til {
+
+  //!
+  //! Compute calls to pure integer functions at compile time.
+  //!
+  //! Functions are interpreted over their (typed) syntax trees. They may only
+  //! use integer arguments and locals, and call themselves or other constant
+  //! functions: anything else (output, input, memory, globals, doubles) makes
+  //! the call be computed at run time, as does running out of steps or
+  //! nesting calls too deeply (the interpreter recurses as they do). The
+  //! results of all the calls computed in a unit are kept.
+  //!
+  class constant_evaluator: public basic_ast_visitor {
+    std::shared_ptr<constant_functions> _constants;
+
+    struct not_constant {}; // thrown when the call cannot be computed
+    struct not_typed: not_constant {}; // thrown when it cannot be computed yet (code not generated)
+
+    std::vector<std::map<std::string, int>> _scopes; // locals of the function being interpreted
+    std::vector<til::function_definition_node*> _functions; // calls being interpreted
+    int _value; // value of the last expression
+    size_t _steps;
+
+    // results of the calls computed so far (none if they never can be computed)
+    std::map<std::pair<til::function_definition_node*, std::vector<int>>, std::optional<int>> _results;
+
+    // control flow
+    bool _returning;
+    int _stopping, _skipping; // loops still to leave or to restart ('stop' and 'next')
+
+  public:
+    constant_evaluator(std::shared_ptr<cdk::compiler> compiler, std::shared_ptr<constant_functions> constants) :
+        basic_ast_visitor(compiler), _constants(constants), _value(0), _steps(0), _returning(false), _stopping(0),
+        _skipping(0) {
+    }
+
+  public:
+    ~constant_evaluator() {
+    }
+
+  public:
+    /** The value returned by a function for the given arguments (if it can be computed). */
+    std::optional<int> call(til::function_definition_node *const function, const std::vector<int> &arguments);
+
+  protected:
+    void reset();
+    int evaluate(cdk::expression_node *const node);
+    int invoke(til::function_definition_node *const function, const std::vector<int> &arguments);
+    int &variable(cdk::lvalue_node *const lvalue);
+    void step(cdk::basic_node *const node);
+    bool interrupted() const {
+      return _returning || _stopping > 0 || _skipping > 0;
+    }
+
+  public:
+    // do not edit these lines
+#define __IN_VISITOR_HEADER__
+#include ".auto/visitor_decls.h"       // automatically generated
+#undef __IN_VISITOR_HEADER__
+    // do not edit these lines: end
+
+  };
+
+} // til
+
+#endif
@@ -0,0 +1,148 @@
+#include <string>
+#include "targets/constant_functions.h"
+#include ".auto/all_nodes.h"  // automatically generated
+#include "til_parser.tab.h"
+
+til::function_definition_node *til::constant_functions::literal(const std::string &name) const {
+  auto it = _literals.find(name);
+  if (it == _literals.end() || _changed.count(name)) return nullptr;
+  return it->second;
+}
+
+static bool same_literal(cdk::expression_node *const left, cdk::expression_node *const right) {
+  auto left_int = dynamic_cast<cdk::integer_node*>(left), right_int = dynamic_cast<cdk::integer_node*>(right);
+  if (left_int && right_int) return left_int->value() == right_int->value();
+  auto left_double = dynamic_cast<cdk::double_node*>(left), right_double = dynamic_cast<cdk::double_node*>(right);
+  return left_double && right_double && left_double->value() == right_double->value();
+}
+
+cdk::expression_node *til::constant_functions::constant_argument(til::function_definition_node *const function,
+                                                                 size_t index) const {
+  // asked for every read of a parameter
+  auto key = std::make_pair(function, index);
+  auto known = _arguments.find(key);
+  if (known != _arguments.end()) return known->second;
+  return _arguments[key] = find_argument(function, index);
+}
+
+cdk::expression_node *til::constant_functions::find_argument(til::function_definition_node *const function,
+                                                             size_t index) const {
+  auto it = _names.find(function);
+  if (it == _names.end()) return nullptr;
+  auto &name = it->second;
+  if (!literal(name) || _values.count(name)) return nullptr; // unknown callers
+
+  auto parameter = dynamic_cast<til::declaration_node*>(function->arguments()->node(index));
+  auto changed = _changed_parameters.find(function);
+  if (!parameter || (changed != _changed_parameters.end() && changed->second.count(parameter->identifier()))) {
+    return nullptr;
+  }
+
+  std::vector<cdk::sequence_node*> calls;
+  if (_calls.count(name)) calls = _calls.at(name);
+  if (_recursive_calls.count(function)) {
+    auto &recursive = _recursive_calls.at(function);
+    calls.insert(calls.end(), recursive.begin(), recursive.end());
+  }
+
+  cdk::expression_node *value = nullptr;
+  for (auto arguments : calls) {
+    if (arguments->size() <= index) return nullptr;
+    auto argument = dynamic_cast<cdk::expression_node*>(arguments->node(index));
+    if (!dynamic_cast<cdk::integer_node*>(argument) && !dynamic_cast<cdk::double_node*>(argument)) return nullptr;
+    if (value && !same_literal(value, argument)) return nullptr;
+    value = argument;
+  }
+  return value;
+}
+
+bool til::constant_functions::local(const std::string &name) const {
+  for (auto &scope : _scopes) {
+    if (scope.count(name)) return true;
+  }
+  return false;
+}
+
+til::function_definition_node *til::constant_functions::parameter_of(const std::string &name) const {
+  for (size_t i = _scopes.size(); i > 0; i--) {
+    if (!_scopes[i - 1].count(name)) continue;
+    auto function = _parameters.find(i - 1);
+    return function == _parameters.end() ? nullptr : function->second;
+  }
+  return nullptr;
+}
+
+void til::constant_functions::change(cdk::lvalue_node *const lvalue) {
+  auto variable = dynamic_cast<cdk::variable_node*>(lvalue);
+  if (!variable) return;
+  if (!local(variable->name())) {
+    _changed.insert(variable->name());
+  } else if (auto function = parameter_of(variable->name())) {
+    _changed_parameters[function].insert(variable->name());
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void til::constant_functions::do_rvalue_node(cdk::rvalue_node *const node, int lvl) {
+  auto variable = dynamic_cast<cdk::variable_node*>(node->lvalue());
+  if (variable && !local(variable->name())) _values.insert(variable->name());
+  ast_walker::do_rvalue_node(node, lvl);
+}
+
+void til::constant_functions::do_assignment_node(cdk::assignment_node *const node, int lvl) {
+  change(node->lvalue());
+  ast_walker::do_assignment_node(node, lvl);
+}
+
+void til::constant_functions::do_address_of_node(til::address_of_node *const node, int lvl) {
+  change(node->lvalue());
+  ast_walker::do_address_of_node(node, lvl);
+}
+
+void til::constant_functions::do_declaration_node(til::declaration_node *const node, int lvl) {
+  ast_walker::do_declaration_node(node, lvl);
+
+  if (!_functions.empty()) {
+    _scopes.back().insert(node->identifier());
+    return;
+  }
+
+  auto literal = dynamic_cast<til::function_definition_node*>(node->initializer());
+  if (node->qualifier() != tPRIVATE || !literal || _literals.count(node->identifier())) {
+    _changed.insert(node->identifier()); // declared elsewhere (or twice)
+  } else {
+    _literals[node->identifier()] = literal;
+    _names[literal] = node->identifier();
+  }
+}
+
+void til::constant_functions::do_block_node(til::block_node *const node, int lvl) {
+  _scopes.emplace_back();
+  ast_walker::do_block_node(node, lvl);
+  _scopes.pop_back();
+}
+
+void til::constant_functions::do_function_call_node(til::function_call_node *const node, int lvl) {
+  node->arguments()->accept(this, lvl);
+
+  auto rvalue = dynamic_cast<cdk::rvalue_node*>(node->func());
+  auto variable = rvalue ? dynamic_cast<cdk::variable_node*>(rvalue->lvalue()) : nullptr;
+  if (!node->func()) {
+    if (!_functions.empty()) _recursive_calls[_functions.back()].push_back(node->arguments());
+  } else if (variable && !local(variable->name())) {
+    _calls[variable->name()].push_back(node->arguments());
+  } else {
+    node->func()->accept(this, lvl);
+  }
+}
+
+void til::constant_functions::do_function_definition_node(til::function_definition_node *const node, int lvl) {
+  _functions.push_back(node);
+  _scopes.emplace_back();
+  _parameters[_scopes.size() - 1] = node;
+  ast_walker::do_function_definition_node(node, lvl);
+  _parameters.erase(_scopes.size() - 1);
+  _scopes.pop_back();
+  _functions.pop_back();
+}
@@ -0,0 +1,72 @@
+#ifndef __TIL_TARGETS_CONSTANT_FUNCTIONS_H__
+#define __TIL_TARGETS_CONSTANT_FUNCTIONS_H__
+
+#include "targets/ast_walker.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace til {
+
+  //!
+  //! Find the global variables of a unit that always hold the same function.
+  //!
+  //! These are private globals initialized with a function literal that are
+  //! never assigned nor have their address taken anywhere in the unit. Public
+  //! globals are left out, as other units may change them.
+  //!
+  //! When such a function is only ever called (directly or with '@'), all
+  //! its calls are known: a parameter that is never changed and always gets
+  //! the same literal is a constant.
+  //!
+  class constant_functions: public ast_walker {
+    std::map<std::string, til::function_definition_node*> _literals; // candidates
+    std::map<til::function_definition_node*, std::string> _names; // global initialized with each candidate
+    std::set<std::string> _changed; // globals that may be changed
+    std::set<std::string> _values; // globals used other than by calling them
+    std::map<std::string, std::vector<cdk::sequence_node*>> _calls; // arguments of the calls through each global
+    std::map<til::function_definition_node*, std::vector<cdk::sequence_node*>> _recursive_calls; // arguments of '@' calls
+    std::map<til::function_definition_node*, std::set<std::string>> _changed_parameters;
+    mutable std::map<std::pair<til::function_definition_node*, size_t>, cdk::expression_node*> _arguments; // answers so far
+
+    std::vector<std::set<std::string>> _scopes; // names of the locals visible in each block
+    std::map<size_t, til::function_definition_node*> _parameters; // scopes holding the arguments of a function
+    std::vector<til::function_definition_node*> _functions; // function definitions being visited
+
+  public:
+    constant_functions(std::shared_ptr<cdk::compiler> compiler) :
+        ast_walker(compiler) {
+    }
+
+  public:
+    ~constant_functions() {
+    }
+
+  public:
+    /** The literal always held by a global variable (if any). */
+    til::function_definition_node *literal(const std::string &name) const;
+
+    /** The literal always passed as a function's argument (if any). */
+    cdk::expression_node *constant_argument(til::function_definition_node *const function, size_t index) const;
+
+  protected:
+    cdk::expression_node *find_argument(til::function_definition_node *const function, size_t index) const;
+    bool local(const std::string &name) const;
+    til::function_definition_node *parameter_of(const std::string &name) const;
+    void change(cdk::lvalue_node *const lvalue);
+
+  public:
+    void do_rvalue_node(cdk::rvalue_node *const node, int lvl);
+    void do_assignment_node(cdk::assignment_node *const node, int lvl);
+    void do_address_of_node(til::address_of_node *const node, int lvl);
+    void do_declaration_node(til::declaration_node *const node, int lvl);
+    void do_block_node(til::block_node *const node, int lvl);
+    void do_function_call_node(til::function_call_node *const node, int lvl);
+    void do_function_definition_node(til::function_definition_node *const node, int lvl);
+
+  };
+
+} // til
+
+#endif
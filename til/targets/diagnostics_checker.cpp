@@ -0,0 +1,78 @@
+#include <string>
+#include "targets/diagnostics_checker.h"
+#include "targets/type_checker.h"
+#include ".auto/all_nodes.h"  // automatically generated
+
+bool til::diagnostics_checker::check(cdk::basic_node *const node) {
+  try {
+    til::type_checker checker(_compiler, _symtab, this);
+    node->accept(&checker, 0);
+    return true;
+  } catch (const std::string &problem) {
+    std::cerr << node->lineno() << ": " << problem << std::endl;
+    _errors++;
+    return false;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void til::diagnostics_checker::do_declaration_node(til::declaration_node *const node, int lvl) {
+  // the initializer's functions are checked after the variable is declared
+  if (check(node)) ast_walker::do_declaration_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_function_definition_node(til::function_definition_node *const node, int lvl) {
+  if (!check(node)) return;
+  _symtab.push();
+  ast_walker::do_function_definition_node(node, lvl);
+  _symtab.pop();
+}
+
+void til::diagnostics_checker::do_block_node(til::block_node *const node, int lvl) {
+  _symtab.push();
+  ast_walker::do_block_node(node, lvl);
+  _symtab.pop();
+}
+
+//---------------------------------------------------------------------------
+
+void til::diagnostics_checker::do_evaluation_node(til::evaluation_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_evaluation_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_print_node(til::print_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_print_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_return_node(til::return_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_return_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_if_node(til::if_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_if_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_if_else_node(til::if_else_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_if_else_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_loop_node(til::loop_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_loop_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_with_node(til::with_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_with_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_unless_node(til::unless_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_unless_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_sweep_node(til::sweep_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_sweep_node(node, lvl);
+}
+
+void til::diagnostics_checker::do_iterate_node(til::iterate_node *const node, int lvl) {
+  if (check(node)) ast_walker::do_iterate_node(node, lvl);
+}
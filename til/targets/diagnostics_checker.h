@@ -0,0 +1,56 @@
+#ifndef __TIL_TARGETS_DIAGNOSTICS_CHECKER_H__
+#define __TIL_TARGETS_DIAGNOSTICS_CHECKER_H__
+
+#include "targets/ast_walker.h"
+
+namespace til {
+
+  //!
+  //! Report the type errors of a unit without generating anything.
+  //!
+  //! Each statement and declaration is checked once, in the scopes the code
+  //! generator would use, and checking goes on after an error so that all
+  //! of them are reported. This is what editors need on every change.
+  //!
+  class diagnostics_checker: public ast_walker {
+    cdk::symbol_table<til::symbol> &_symtab;
+    size_t _errors;
+
+  public:
+    diagnostics_checker(std::shared_ptr<cdk::compiler> compiler, cdk::symbol_table<til::symbol> &symtab) :
+        ast_walker(compiler), _symtab(symtab), _errors(0) {
+    }
+
+  public:
+    ~diagnostics_checker() {
+    }
+
+  public:
+    size_t errors() const {
+      return _errors;
+    }
+
+  protected:
+    /** Type check a node, reporting (and counting) its error if it has one. */
+    bool check(cdk::basic_node *const node);
+
+  public:
+    void do_declaration_node(til::declaration_node *const node, int lvl);
+    void do_function_definition_node(til::function_definition_node *const node, int lvl);
+    void do_block_node(til::block_node *const node, int lvl);
+    void do_evaluation_node(til::evaluation_node *const node, int lvl);
+    void do_print_node(til::print_node *const node, int lvl);
+    void do_return_node(til::return_node *const node, int lvl);
+    void do_if_node(til::if_node *const node, int lvl);
+    void do_if_else_node(til::if_else_node *const node, int lvl);
+    void do_loop_node(til::loop_node *const node, int lvl);
+    void do_with_node(til::with_node *const node, int lvl);
+    void do_unless_node(til::unless_node *const node, int lvl);
+    void do_sweep_node(til::sweep_node *const node, int lvl);
+    void do_iterate_node(til::iterate_node *const node, int lvl);
+
+  };
+
+} // til
+
+#endif
@@ -0,0 +1,182 @@
+#include <string>
+#include "targets/escape_analysis.h"
+#include ".auto/all_nodes.h"  // automatically generated
+
+void til::escape_analysis::analyse(til::function_definition_node *const function) {
+  // copies between locals may only be seen on a later pass (e.g. in loops)
+  do {
+    _changed = false;
+    _scopes.clear();
+    _scopes.emplace_back();
+    function->arguments()->accept(this, 0);
+    function->block()->accept(this, 0);
+  } while (_changed);
+}
+
+std::set<cdk::basic_node*> til::escape_analysis::flow(cdk::basic_node *const expression) {
+  _flow.clear();
+  expression->accept(this, 0);
+  return _flow;
+}
+
+void til::escape_analysis::allocate(cdk::basic_node *const allocation) {
+  _allocations.insert(allocation);
+  _flow = { allocation };
+}
+
+void til::escape_analysis::escape(const std::set<cdk::basic_node*> &allocations) {
+  _escaping.insert(allocations.begin(), allocations.end());
+}
+
+void til::escape_analysis::flow_into(til::declaration_node *const local, const std::set<cdk::basic_node*> &allocations) {
+  auto &reaching = _points_to[local];
+  for (auto allocation : allocations) {
+    if (reaching.insert(allocation).second) _changed = true;
+  }
+}
+
+til::declaration_node *til::escape_analysis::local(cdk::lvalue_node *const lvalue) {
+  auto variable = dynamic_cast<cdk::variable_node*>(lvalue);
+  if (!variable) return nullptr;
+  for (auto scope = _scopes.rbegin(); scope != _scopes.rend(); scope++) {
+    auto it = scope->find(variable->name());
+    if (it != scope->end()) return it->second;
+  }
+  return nullptr; // global
+}
+
+//---------------------------------------------------------------------------
+
+void til::escape_analysis::do_unary_operation(cdk::unary_operation_node *const node, int lvl) {
+  node->argument()->accept(this, lvl);
+  _flow.clear();
+}
+
+void til::escape_analysis::do_binary_operation(cdk::binary_operation_node *const node, int lvl) {
+  auto left = flow(node->left());
+  auto right = flow(node->right());
+  _flow.clear();
+  if (dynamic_cast<cdk::add_node*>(node) || dynamic_cast<cdk::sub_node*>(node)) {
+    // pointer arithmetic stays within the buffer
+    _flow.insert(left.begin(), left.end());
+    _flow.insert(right.begin(), right.end());
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void til::escape_analysis::do_objects_node(til::objects_node *const node, int lvl) {
+  flow(node->argument());
+  allocate(node);
+}
+
+void til::escape_analysis::do_read_node(til::read_node *const node, int lvl) {
+  if (node->count()) {
+    flow(node->count());
+    allocate(node);
+  } else {
+    _flow.clear();
+  }
+}
+
+void til::escape_analysis::do_sizeof_node(til::sizeof_node *const node, int lvl) {
+  _flow.clear(); // the expression is not evaluated
+}
+
+void til::escape_analysis::do_rvalue_node(cdk::rvalue_node *const node, int lvl) {
+  node->lvalue()->accept(this, lvl);
+  auto variable = local(node->lvalue());
+  if (variable) {
+    _flow = _points_to[variable];
+  } else {
+    _flow.clear(); // loaded from memory or from a global: not ours
+  }
+}
+
+void til::escape_analysis::do_address_of_node(til::address_of_node *const node, int lvl) {
+  if (auto element = dynamic_cast<til::index_node*>(node->lvalue())) {
+    auto base = flow(element->base());
+    flow(element->index());
+    _flow = base;
+    return;
+  }
+
+  auto variable = local(node->lvalue());
+  if (variable) {
+    // the local may be changed behind our back
+    escape(_points_to[variable]);
+  }
+  _flow.clear();
+}
+
+void til::escape_analysis::do_assignment_node(cdk::assignment_node *const node, int lvl) {
+  auto value = flow(node->rvalue());
+  auto variable = local(node->lvalue());
+  if (variable) {
+    flow_into(variable, value);
+  } else {
+    flow(node->lvalue());
+    escape(value); // stored in memory or in a global
+  }
+  _flow = value;
+}
+
+void til::escape_analysis::do_declaration_node(til::declaration_node *const node, int lvl) {
+  std::set<cdk::basic_node*> value;
+  if (node->initializer()) value = flow(node->initializer());
+  _scopes.back()[node->identifier()] = node;
+  flow_into(node, value);
+}
+
+void til::escape_analysis::do_block_node(til::block_node *const node, int lvl) {
+  _scopes.emplace_back();
+  ast_walker::do_block_node(node, lvl);
+  _scopes.pop_back();
+}
+
+//---------------------------------------------------------------------------
+
+void til::escape_analysis::do_function_call_node(til::function_call_node *const node, int lvl) {
+  _calls = true;
+  for (size_t i = 0; i < node->arguments()->size(); i++) {
+    escape(flow(node->arguments()->node(i)));
+  }
+  if (node->func()) flow(node->func());
+  _flow.clear();
+}
+
+void til::escape_analysis::do_function_definition_node(til::function_definition_node *const node, int lvl) {
+  _flow.clear(); // analysed when it is generated
+}
+
+void til::escape_analysis::do_return_node(til::return_node *const node, int lvl) {
+  if (node->retval()) escape(flow(node->retval()));
+}
+
+//---------------------------------------------------------------------------
+
+void til::escape_analysis::do_with_node(til::with_node *const node, int lvl) {
+  _calls = true; // only the elements are passed to the function
+  ast_walker::do_with_node(node, lvl);
+}
+
+void til::escape_analysis::do_unless_node(til::unless_node *const node, int lvl) {
+  _calls = true;
+  ast_walker::do_unless_node(node, lvl);
+}
+
+void til::escape_analysis::do_sweep_node(til::sweep_node *const node, int lvl) {
+  _calls = true;
+  ast_walker::do_sweep_node(node, lvl);
+}
+
+void til::escape_analysis::do_iterate_node(til::iterate_node *const node, int lvl) {
+  _calls = true;
+  ast_walker::do_iterate_node(node, lvl);
+}
+
+void til::escape_analysis::do_reduce_node(til::reduce_node *const node, int lvl) {
+  _calls = true; // only the elements are passed to the function
+  ast_walker::do_reduce_node(node, lvl);
+  _flow.clear();
+}
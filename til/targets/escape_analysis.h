@@ -0,0 +1,92 @@
+#ifndef __TIL_TARGETS_ESCAPE_ANALYSIS_H__
+#define __TIL_TARGETS_ESCAPE_ANALYSIS_H__
+
+#include "targets/ast_walker.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace til {
+
+  //!
+  //! Find which allocations of a function may outlive it.
+  //!
+  //! A buffer escapes when a pointer into it is returned, passed to a
+  //! function, stored in memory or in a global variable, or when the
+  //! address of a local holding it is taken. Pointers copied between
+  //! locals are followed until no more allocations reach any local.
+  //! Nested functions are analysed on their own.
+  //!
+  class escape_analysis: public ast_walker {
+    std::vector<std::map<std::string, til::declaration_node*>> _scopes; // locals visible in each block
+    std::map<til::declaration_node*, std::set<cdk::basic_node*>> _points_to; // allocations reaching each local
+    std::set<cdk::basic_node*> _allocations; // allocation sites of the function
+    std::set<cdk::basic_node*> _escaping; // allocations that may outlive the function
+    std::set<cdk::basic_node*> _flow; // allocations reaching the last visited expression
+    bool _calls; // whether the function calls other functions
+    bool _changed;
+
+  public:
+    escape_analysis(std::shared_ptr<cdk::compiler> compiler) :
+        ast_walker(compiler), _calls(false), _changed(false) {
+    }
+
+  public:
+    ~escape_analysis() {
+    }
+
+  public:
+    /** Analyse the arguments and body of a function. */
+    void analyse(til::function_definition_node *const function);
+
+    const std::set<cdk::basic_node*> &allocations() const {
+      return _allocations;
+    }
+
+    bool escapes(cdk::basic_node *const allocation) const {
+      return _escaping.count(allocation) > 0;
+    }
+
+    bool any_escapes() const {
+      return !_escaping.empty();
+    }
+
+    /** Whether the function calls (and so may allocate through) other functions. */
+    bool calls() const {
+      return _calls;
+    }
+
+  protected:
+    std::set<cdk::basic_node*> flow(cdk::basic_node *const expression);
+    void allocate(cdk::basic_node *const allocation);
+    void escape(const std::set<cdk::basic_node*> &allocations);
+    void flow_into(til::declaration_node *const local, const std::set<cdk::basic_node*> &allocations);
+    til::declaration_node *local(cdk::lvalue_node *const lvalue);
+
+    void do_unary_operation(cdk::unary_operation_node *const node, int lvl);
+    void do_binary_operation(cdk::binary_operation_node *const node, int lvl);
+
+  public:
+    void do_objects_node(til::objects_node *const node, int lvl);
+    void do_read_node(til::read_node *const node, int lvl);
+    void do_sizeof_node(til::sizeof_node *const node, int lvl);
+    void do_rvalue_node(cdk::rvalue_node *const node, int lvl);
+    void do_address_of_node(til::address_of_node *const node, int lvl);
+    void do_assignment_node(cdk::assignment_node *const node, int lvl);
+    void do_declaration_node(til::declaration_node *const node, int lvl);
+    void do_block_node(til::block_node *const node, int lvl);
+    void do_function_call_node(til::function_call_node *const node, int lvl);
+    void do_function_definition_node(til::function_definition_node *const node, int lvl);
+    void do_return_node(til::return_node *const node, int lvl);
+    void do_with_node(til::with_node *const node, int lvl);
+    void do_unless_node(til::unless_node *const node, int lvl);
+    void do_sweep_node(til::sweep_node *const node, int lvl);
+    void do_iterate_node(til::iterate_node *const node, int lvl);
+    void do_reduce_node(til::reduce_node *const node, int lvl);
+
+  };
+
+} // til
+
+#endif
@@ -1,6 +1,7 @@
 #include <string>
 #include "targets/frame_size_calculator.h"
 #include "targets/type_checker.h"
+#include "targets/value_numbering.h"
 #include "targets/symbol.h"
 #include ".auto/all_nodes.h"
 
@@ -16,53 +17,97 @@ void til::frame_size_calculator::do_sequence_node(cdk::sequence_node *const node
   }
 }
 
+void til::frame_size_calculator::reserve(size_t size) {
+  _current += size;
+  _localsize = std::max(_localsize, _current);
+}
+
+void til::frame_size_calculator::reserve_temporary(size_t size) {
+  _localsize = std::max(_localsize, _current + size);
+}
+
 void til::frame_size_calculator::do_block_node(til::block_node *const node, int lvl) {
+  auto current = _current;
   _symtab.push();
   if (node->declarations()) node->declarations()->accept(this, lvl + 2);
   if (node->instructions()) node->instructions()->accept(this, lvl + 2);
   _symtab.pop();
+  _current = current; // the block's slots are free again
 }
 
 void til::frame_size_calculator::do_if_node(til::if_node *const node, int lvl) {
+  do_reused_values(node->condition(), lvl);
   node->block()->accept(this, lvl + 2);
 }
 
 void til::frame_size_calculator::do_if_else_node(til::if_else_node *const node, int lvl) {
+  do_reused_values(node->condition(), lvl);
   node->thenblock()->accept(this, lvl + 2);
   if (node->elseblock()) node->elseblock()->accept(this, lvl + 2);
 }
 
 void til::frame_size_calculator::do_declaration_node(til::declaration_node *const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
-  _localsize += node->type()->size();
+  reserve(node->type()->size());
+  if (node->initializer()) do_reused_values(node->initializer(), lvl);
 }
 
 void til::frame_size_calculator::do_loop_node(til::loop_node * const node, int lvl) {
+  do_reused_values(node->condition(), lvl);
   node->instruction()->accept(this, lvl);
 }
 
+// the loops of with, unless, sweep and iterate declare and test their
+// operands one at a time (see postfix_writer::counted_loop)
+
 void til::frame_size_calculator::do_with_node(til::with_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
 
-  _localsize += 2 * 4;
+  reserve_temporary(2 * 4);
+  do_reused_values(node->low(), lvl);
+  do_reused_values(node->high(), lvl);
 }
 
 void til::frame_size_calculator::do_unless_node(til::unless_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
 
-  _localsize += 2 * 4;
+  reserve_temporary(2 * 4);
+  do_reused_values(node->condition(), lvl);
+  do_reused_values(node->count(), lvl);
 }
 
 void til::frame_size_calculator::do_sweep_node(til::sweep_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
 
-  _localsize += 4;
+  reserve_temporary(4);
+  do_reused_values(node->low(), lvl);
+  do_reused_values(node->high(), lvl);
+  do_reused_values(node->condition(), lvl);
 }
 
 void til::frame_size_calculator::do_iterate_node(til::iterate_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
 
-  _localsize += 4;
+  reserve_temporary(4);
+  do_reused_values(node->count(), lvl);
+  do_reused_values(node->condition(), lvl);
+}
+
+void til::frame_size_calculator::do_evaluation_node(til::evaluation_node *const node, int lvl) {
+  do_reused_values(node, lvl);
+}
+void til::frame_size_calculator::do_print_node(til::print_node *const node, int lvl) {
+  do_reused_values(node, lvl);
+}
+void til::frame_size_calculator::do_return_node(til::return_node *const node, int lvl) {
+  do_reused_values(node, lvl);
+}
+
+void til::frame_size_calculator::do_reused_values(cdk::basic_node *const node, int lvl) {
+  // temporary slots for common subexpressions (see postfix_writer::open_cse)
+  value_numbering numbering(_compiler);
+  node->accept(&numbering, lvl);
+  reserve_temporary(8 * numbering.repeated().size());
 }
 //---------------------------------------------------------------------------
 
@@ -141,12 +186,6 @@ void til::frame_size_calculator::do_string_node(cdk::string_node *const node, in
 void til::frame_size_calculator::do_sub_node(cdk::sub_node *const node, int lvl) {
   // EMPTY
 }
-void til::frame_size_calculator::do_evaluation_node(til::evaluation_node *const node, int lvl) {
-  // EMPTY
-}
-void til::frame_size_calculator::do_print_node(til::print_node *const node, int lvl) {
-  // EMPTY
-}
 void til::frame_size_calculator::do_read_node(til::read_node *const node, int lvl) {
   // EMPTY
 }
@@ -171,9 +210,9 @@ void til::frame_size_calculator::do_stop_node(til::stop_node * const node, int l
 void til::frame_size_calculator::do_null_node(til::null_node *const node, int lvl) {
   // EMPTY
 }
-void til::frame_size_calculator::do_return_node(til::return_node *const node, int lvl) {
+void til::frame_size_calculator::do_objects_node(til::objects_node *const node, int lvl) {
   // EMPTY
 }
-void til::frame_size_calculator::do_objects_node(til::objects_node *const node, int lvl) {
+void til::frame_size_calculator::do_reduce_node(til::reduce_node *const node, int lvl) {
   // EMPTY
 }
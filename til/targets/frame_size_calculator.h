@@ -10,11 +10,12 @@ namespace til {
 
   class frame_size_calculator: public basic_ast_visitor {
     cdk::symbol_table<til::symbol> &_symtab;
-    size_t _localsize;
+    size_t _localsize; // largest frame needed at any point
+    size_t _current; // slots in use at the current point (sibling blocks share slots)
 
   public:
     frame_size_calculator(std::shared_ptr<cdk::compiler> compiler, cdk::symbol_table<til::symbol> &symtab) :
-        basic_ast_visitor(compiler), _symtab(symtab), _localsize(0) {
+        basic_ast_visitor(compiler), _symtab(symtab), _localsize(0), _current(0) {
     }
 
   public:
@@ -25,6 +26,11 @@ namespace til {
       return _localsize;
     }
 
+  protected:
+    void reserve(size_t size);
+    void reserve_temporary(size_t size);
+    void do_reused_values(cdk::basic_node *const node, int lvl);
+
   public:
   // do not edit these lines
 #define __IN_VISITOR_HEADER__
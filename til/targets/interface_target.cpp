@@ -0,0 +1,4 @@
+#include "targets/interface_target.h"
+
+/** @var create and register a target for unit interfaces. */
+til::interface_target til::interface_target::_self;
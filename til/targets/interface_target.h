@@ -0,0 +1,32 @@
+#ifndef __TIL_TARGETS_INTERFACE_TARGET_H__
+#define __TIL_TARGETS_INTERFACE_TARGET_H__
+
+#include <cdk/targets/basic_target.h>
+#include <cdk/ast/basic_node.h>
+#include "targets/interface_writer.h"
+
+namespace til {
+
+  class interface_target: public cdk::basic_target {
+    static interface_target _self;
+
+  private:
+    interface_target() :
+        cdk::basic_target("tili") {
+    }
+
+  public:
+    bool evaluate(std::shared_ptr<cdk::compiler> compiler) {
+      // symbols are only needed to find the types of 'var' declarations
+      cdk::symbol_table<til::symbol> symtab;
+
+      interface_writer writer(compiler, symtab);
+      compiler->ast()->accept(&writer, 0);
+      return true;
+    }
+
+  };
+
+} // til
+
+#endif
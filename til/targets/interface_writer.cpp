@@ -0,0 +1,43 @@
+#include <string>
+#include "targets/interface_writer.h"
+#include "targets/type_checker.h"
+#include ".auto/all_nodes.h"  // automatically generated
+#include "til_parser.tab.h"
+
+std::string til::interface_writer::source_type(std::shared_ptr<cdk::basic_type> type) const {
+  if (type->name() == cdk::TYPE_INT) return "int";
+  if (type->name() == cdk::TYPE_DOUBLE) return "double";
+  if (type->name() == cdk::TYPE_STRING) return "string";
+  if (type->name() == cdk::TYPE_VOID) return "void";
+
+  if (type->name() == cdk::TYPE_POINTER) {
+    auto referenced = cdk::reference_type::cast(type)->referenced();
+    return source_type(referenced) + "!";
+  }
+
+  auto function = cdk::functional_type::cast(type);
+  std::string text = "(" + source_type(function->output(0));
+  if (function->input_length() > 0) {
+    text += " (";
+    for (size_t i = 0; i < function->input_length(); i++) {
+      text += (i > 0 ? " " : "") + source_type(function->input(i));
+    }
+    text += ")";
+  }
+  return text + ")";
+}
+
+//---------------------------------------------------------------------------
+
+void til::interface_writer::do_declaration_node(til::declaration_node *const node, int lvl) {
+  if (!node->type()) {
+    // the type comes from the initializer
+    ASSERT_SAFE_EXPRESSIONS;
+  }
+  if (node->qualifier() != tPUBLIC) return;
+  os() << "(forward " << source_type(node->type()) << " " << node->identifier() << ")" << std::endl;
+}
+
+void til::interface_writer::do_function_definition_node(til::function_definition_node *const node, int lvl) {
+  // EMPTY: the program is not part of the interface
+}
@@ -0,0 +1,39 @@
+#ifndef __TIL_TARGETS_INTERFACE_WRITER_H__
+#define __TIL_TARGETS_INTERFACE_WRITER_H__
+
+#include "targets/ast_walker.h"
+#include <cdk/types/types.h>
+
+namespace til {
+
+  //!
+  //! Write the interface of a unit: one forward declaration for each of its
+  //! public symbols. Other units import it by placing it before their own
+  //! declarations, instead of repeating the declarations by hand.
+  //!
+  class interface_writer: public ast_walker {
+    cdk::symbol_table<til::symbol> &_symtab;
+
+  public:
+    interface_writer(std::shared_ptr<cdk::compiler> compiler, cdk::symbol_table<til::symbol> &symtab) :
+        ast_walker(compiler), _symtab(symtab) {
+    }
+
+  public:
+    ~interface_writer() {
+      os().flush();
+    }
+
+  protected:
+    /** A type, written as in TIL sources. */
+    std::string source_type(std::shared_ptr<cdk::basic_type> type) const;
+
+  public:
+    void do_declaration_node(til::declaration_node *const node, int lvl);
+    void do_function_definition_node(til::function_definition_node *const node, int lvl);
+
+  };
+
+} // til
+
+#endif
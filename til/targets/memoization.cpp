@@ -0,0 +1,108 @@
+#include <string>
+#include "targets/memoization.h"
+#include ".auto/all_nodes.h"  // automatically generated
+
+void til::memoization::analyse(til::function_definition_node *const function) {
+  auto type = cdk::functional_type::cast(function->type());
+  auto argument = function->arguments()->size() == 1
+      ? dynamic_cast<til::declaration_node*>(function->arguments()->node(0)) : nullptr;
+  if (function->is_main() || !type || !type->output(0) || type->output(0)->name() != cdk::TYPE_INT
+      || !argument || !integer(argument)) {
+    impure();
+    return;
+  }
+
+  _scopes.assign(1, { argument->identifier() });
+  function->block()->accept(this, 0);
+}
+
+bool til::memoization::integer(til::declaration_node *const node) const {
+  return node->type() && node->type()->name() == cdk::TYPE_INT;
+}
+
+/** The scope declaring a variable (-1 if it is not a local). */
+int til::memoization::scope_of(cdk::lvalue_node *const lvalue) const {
+  auto variable = dynamic_cast<cdk::variable_node*>(lvalue);
+  if (!variable) return -1;
+  for (size_t i = _scopes.size(); i > 0; i--) {
+    if (_scopes[i - 1].count(variable->name())) return i - 1;
+  }
+  return -1;
+}
+
+//---------------------------------------------------------------------------
+
+void til::memoization::do_double_node(cdk::double_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_string_node(cdk::string_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_null_node(til::null_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_objects_node(til::objects_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_index_node(til::index_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_read_node(til::read_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_print_node(til::print_node *const node, int lvl) {
+  impure();
+}
+
+void til::memoization::do_rvalue_node(cdk::rvalue_node *const node, int lvl) {
+  if (scope_of(node->lvalue()) < 0) impure(); // global or memory
+}
+
+void til::memoization::do_address_of_node(til::address_of_node *const node, int lvl) {
+  impure();
+}
+
+void til::memoization::do_assignment_node(cdk::assignment_node *const node, int lvl) {
+  if (scope_of(node->lvalue()) <= 0) impure(); // the argument identifies the result
+  node->rvalue()->accept(this, lvl);
+}
+
+void til::memoization::do_declaration_node(til::declaration_node *const node, int lvl) {
+  if (!integer(node)) impure();
+  ast_walker::do_declaration_node(node, lvl);
+  _scopes.back().insert(node->identifier());
+}
+
+void til::memoization::do_block_node(til::block_node *const node, int lvl) {
+  _scopes.emplace_back();
+  ast_walker::do_block_node(node, lvl);
+  _scopes.pop_back();
+}
+
+void til::memoization::do_function_call_node(til::function_call_node *const node, int lvl) {
+  if (node->func()) impure(); // other functions may have effects
+  _recursive = true;
+  node->arguments()->accept(this, lvl);
+}
+
+void til::memoization::do_function_definition_node(til::function_definition_node *const node, int lvl) {
+  impure();
+}
+
+//---------------------------------------------------------------------------
+
+void til::memoization::do_with_node(til::with_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_unless_node(til::unless_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_sweep_node(til::sweep_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_iterate_node(til::iterate_node *const node, int lvl) {
+  impure();
+}
+void til::memoization::do_reduce_node(til::reduce_node *const node, int lvl) {
+  impure();
+}
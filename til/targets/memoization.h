@@ -0,0 +1,78 @@
+#ifndef __TIL_TARGETS_MEMOIZATION_H__
+#define __TIL_TARGETS_MEMOIZATION_H__
+
+#include "targets/ast_walker.h"
+
+#include <set>
+#include <vector>
+
+// entries of the (direct-mapped) table of results of each memoized function (a power of 2)
+#ifndef TIL_MEMO_ENTRIES
+#define TIL_MEMO_ENTRIES 1024
+#endif
+
+namespace til {
+
+  //!
+  //! Decide whether the results of a function may be remembered.
+  //!
+  //! These are recursive functions ('@') from one integer to an integer that
+  //! only use their argument and integer locals: no globals, memory, input or
+  //! output, and no calls to other functions. The argument is never changed,
+  //! so it identifies the result when the function returns.
+  //!
+  class memoization: public ast_walker {
+    std::vector<std::set<std::string>> _scopes; // locals visible in each block (the first holds the argument)
+    bool _pure;
+    bool _recursive;
+
+  public:
+    memoization(std::shared_ptr<cdk::compiler> compiler) :
+        ast_walker(compiler), _pure(true), _recursive(false) {
+    }
+
+  public:
+    ~memoization() {
+    }
+
+  public:
+    /** Analyse the arguments and body of a function. */
+    void analyse(til::function_definition_node *const function);
+
+    bool memoizable() const {
+      return _pure && _recursive;
+    }
+
+  protected:
+    void impure() {
+      _pure = false;
+    }
+    bool integer(til::declaration_node *const node) const;
+    int scope_of(cdk::lvalue_node *const lvalue) const;
+
+  public:
+    void do_double_node(cdk::double_node *const node, int lvl);
+    void do_string_node(cdk::string_node *const node, int lvl);
+    void do_null_node(til::null_node *const node, int lvl);
+    void do_objects_node(til::objects_node *const node, int lvl);
+    void do_index_node(til::index_node *const node, int lvl);
+    void do_read_node(til::read_node *const node, int lvl);
+    void do_print_node(til::print_node *const node, int lvl);
+    void do_rvalue_node(cdk::rvalue_node *const node, int lvl);
+    void do_address_of_node(til::address_of_node *const node, int lvl);
+    void do_assignment_node(cdk::assignment_node *const node, int lvl);
+    void do_declaration_node(til::declaration_node *const node, int lvl);
+    void do_block_node(til::block_node *const node, int lvl);
+    void do_function_call_node(til::function_call_node *const node, int lvl);
+    void do_function_definition_node(til::function_definition_node *const node, int lvl);
+    void do_with_node(til::with_node *const node, int lvl);
+    void do_unless_node(til::unless_node *const node, int lvl);
+    void do_sweep_node(til::sweep_node *const node, int lvl);
+    void do_iterate_node(til::iterate_node *const node, int lvl);
+    void do_reduce_node(til::reduce_node *const node, int lvl);
+
+  };
+
+} // til
+
+#endif
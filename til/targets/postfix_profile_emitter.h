@@ -0,0 +1,124 @@
+#ifndef __TIL_TARGETS_POSTFIX_PROFILE_EMITTER_H__
+#define __TIL_TARGETS_POSTFIX_PROFILE_EMITTER_H__
+
+#include "targets/postfix_sse2_emitter.h"
+
+#include <string>
+
+// file written by instrumented programs when their main function returns
+#ifndef TIL_PROFILE_FILE
+#define TIL_PROFILE_FILE "til-profile.out"
+#endif
+
+namespace til {
+
+  //!
+  //! The postfix machine, with instructions for counting the calls and the
+  //! cycles (rdtsc) spent in each function.
+  //!
+  //! Each function has a 64-byte record in the til_profile section: calls,
+  //! active calls, cycles in all calls (recursion counted once), cycles in
+  //! the function itself (callees excluded), and its name. The linker joins
+  //! the records of all units, and main writes them to TIL_PROFILE_FILE when
+  //! it returns (see til-profile.sh).
+  //!
+  //! Cycles spent in callees are added to _til_profile_children, which each
+  //! function saves on entry (with its own timestamp) in 16 bytes of its frame.
+  //! These instructions only use registers (not the postfix stack), and may be
+  //! placed wherever no register holds a value.
+  //!
+  class postfix_profile_emitter: public postfix_sse2_emitter {
+  private:
+    static std::string frame(int offset) {
+      return offset < 0 ? "[ebp-" + std::to_string(-offset) + "]" : "[ebp+" + std::to_string(offset) + "]";
+    }
+
+  public:
+    postfix_profile_emitter(std::shared_ptr<cdk::compiler> compiler) :
+        postfix_sse2_emitter(compiler) {
+    }
+
+  public:
+    /** Declare the unit's profile data (before its first use). */
+    void PROFILE_UNIT() {
+      os() << "\tcommon\t_til_profile_children 8\n";
+      os() << "\textern\t__start_til_profile\n";
+      os() << "\textern\t__stop_til_profile\n";
+    }
+
+    /** The (empty) record of a function. */
+    void PROFILE_RECORD(const std::string &label, const std::string &name) {
+      auto text = name.substr(0, 31);
+      os() << "section til_profile progbits alloc noexec write align=4\n";
+      os() << "align 4\n";
+      os() << label << ":\n";
+      os() << "\tdd\t0, 0, 0, 0, 0, 0, 0, 0\n";
+      os() << "\tdb\t\"" << text << "\"\n";
+      os() << "\ttimes\t" << 32 - text.size() << " db 0\n";
+    }
+
+    /** Count a call and start its clock (the frame slot holds 16 bytes). */
+    void PROFILE_ENTER(const std::string &record, int slot) {
+      os() << "\tinc\tdword [" << record << "]\n";
+      os() << "\tinc\tdword [" << record << "+4]\n";
+      os() << "\tmov\teax, [_til_profile_children]\n";
+      os() << "\tmov\tedx, [_til_profile_children+4]\n";
+      os() << "\tmov\t" << frame(slot + 8) << ", eax\n";
+      os() << "\tmov\t" << frame(slot + 12) << ", edx\n";
+      os() << "\tmov\tdword [_til_profile_children], 0\n";
+      os() << "\tmov\tdword [_til_profile_children+4], 0\n";
+      os() << "\trdtsc\n";
+      os() << "\tmov\t" << frame(slot) << ", eax\n";
+      os() << "\tmov\t" << frame(slot + 4) << ", edx\n";
+    }
+
+    /** Stop the clock of a call and charge its cycles (skip is a fresh label). */
+    void PROFILE_LEAVE(const std::string &record, int slot, const std::string &skip) {
+      os() << "\trdtsc\n";
+      os() << "\tsub\teax, " << frame(slot) << "\n";
+      os() << "\tsbb\tedx, " << frame(slot + 4) << "\n";
+      os() << "\tmov\tecx, eax\n";
+      os() << "\tpush\tedx\n";
+      os() << "\tsub\tecx, [_til_profile_children]\n";
+      os() << "\tsbb\tedx, [_til_profile_children+4]\n";
+      os() << "\tadd\t[" << record << "+16], ecx\n";
+      os() << "\tadc\t[" << record << "+20], edx\n";
+      os() << "\tpop\tedx\n";
+      os() << "\tdec\tdword [" << record << "+4]\n";
+      os() << "\tjnz\t" << skip << "\n"; // an outer call of the same function is still running
+      os() << "\tadd\t[" << record << "+8], eax\n";
+      os() << "\tadc\t[" << record << "+12], edx\n";
+      os() << skip << ":\n";
+      os() << "\tadd\teax, " << frame(slot + 8) << "\n";
+      os() << "\tadc\tedx, " << frame(slot + 12) << "\n";
+      os() << "\tmov\t[_til_profile_children], eax\n";
+      os() << "\tmov\t[_til_profile_children+4], edx\n";
+    }
+
+    /** Write the records of all units to a file (its name is a string at label file). */
+    void PROFILE_DUMP(const std::string &file, const std::string &skip) {
+      os() << "\tpush\tebx\n";
+      os() << "\tmov\teax, 5\n"; // open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+      os() << "\tmov\tebx, " << file << "\n";
+      os() << "\tmov\tecx, 0x241\n";
+      os() << "\tmov\tedx, 420\n";
+      os() << "\tint\t0x80\n";
+      os() << "\ttest\teax, eax\n";
+      os() << "\tjs\t" << skip << "\n";
+      os() << "\tmov\tebx, eax\n";
+      os() << "\tmov\teax, 4\n"; // write(fd, records, size)
+      os() << "\tmov\tecx, __start_til_profile\n";
+      os() << "\tmov\tedx, __stop_til_profile\n";
+      os() << "\tsub\tedx, ecx\n";
+      os() << "\tint\t0x80\n";
+      os() << "\tmov\teax, 6\n"; // close(fd)
+      os() << "\tint\t0x80\n";
+      os() << skip << ":\n";
+      os() << "\tpop\tebx\n";
+    }
+
+  };
+
+} // til
+
+#endif
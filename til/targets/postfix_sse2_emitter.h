@@ -0,0 +1,100 @@
+#ifndef __TIL_TARGETS_POSTFIX_SSE2_EMITTER_H__
+#define __TIL_TARGETS_POSTFIX_SSE2_EMITTER_H__
+
+#include <cdk/emitters/postfix_ix86_emitter.h>
+
+namespace til {
+
+  //!
+  //! The ix86 postfix machine, with double arithmetic done by SSE2 scalar
+  //! instructions instead of the x87 unit.
+  //!
+  //! Doubles still live on the postfix stack (8 bytes each, as before) and
+  //! functions still return them in st0, as the runtime library expects:
+  //! only the instructions operating on them change.
+  //!
+  //! It also has the few integer instructions that the base machine lacks.
+  //!
+  class postfix_sse2_emitter: public cdk::postfix_ix86_emitter {
+  public:
+    postfix_sse2_emitter(std::shared_ptr<cdk::compiler> compiler) :
+        cdk::postfix_ix86_emitter(compiler) {
+    }
+
+  private:
+    // replace the two doubles on top of the stack by their combination
+    void arithmetic(const char *instruction) {
+      os() << "\tmovsd\txmm0, [esp+8]\n";
+      os() << "\t" << instruction << "\txmm0, [esp]\n";
+      os() << "\tadd\tesp, byte 8\n";
+      os() << "\tmovsd\t[esp], xmm0\n";
+    }
+
+  public:
+    void DADD() {
+      arithmetic("addsd");
+    }
+    void DSUB() {
+      arithmetic("subsd");
+    }
+    void DMUL() {
+      arithmetic("mulsd");
+    }
+    void DDIV() {
+      arithmetic("divsd");
+    }
+    void DNEG() {
+      os() << "\txor\tdword [esp+4], 0x80000000\n"; // the sign bit
+    }
+
+    /** Replace the two doubles on top of the stack by -1, 0 or 1. */
+    void DCMP() {
+      os() << "\txor\teax, eax\n";
+      os() << "\txor\tecx, ecx\n";
+      os() << "\tmovsd\txmm0, [esp+8]\n";
+      os() << "\tucomisd\txmm0, [esp]\n";
+      os() << "\tseta\tal\n";
+      os() << "\tsetb\tcl\n";
+      os() << "\tsub\teax, ecx\n";
+      os() << "\tadd\tesp, byte 12\n";
+      os() << "\tmov\t[esp], eax\n";
+    }
+
+    void I2D() {
+      os() << "\tcvtsi2sd\txmm0, dword [esp]\n";
+      os() << "\tsub\tesp, byte 4\n";
+      os() << "\tmovsd\t[esp], xmm0\n";
+    }
+
+    /** Replace the two integers on top of the stack by the high half of their (signed) product. */
+    void MULHI() {
+      os() << "\tpop\teax\n";
+      os() << "\timul\tdword [esp]\n"; // edx:eax
+      os() << "\tmov\t[esp], edx\n";
+    }
+
+    /** End the program, with the status on top of the stack. */
+    void EXIT() {
+      os() << "\tpop\tebx\n";
+      os() << "\tmov\teax, 1\n"; // exit(status)
+      os() << "\tint\t0x80\n";
+    }
+
+    void LDDOUBLE() {
+      os() << "\tmov\teax, [esp]\n";
+      os() << "\tmovsd\txmm0, [eax]\n";
+      os() << "\tsub\tesp, byte 4\n";
+      os() << "\tmovsd\t[esp], xmm0\n";
+    }
+    void STDOUBLE() {
+      os() << "\tmov\teax, [esp]\n";
+      os() << "\tmovsd\txmm0, [esp+4]\n";
+      os() << "\tmovsd\t[eax], xmm0\n";
+      os() << "\tadd\tesp, byte 12\n";
+    }
+
+  };
+
+} // til
+
+#endif
@@ -4,8 +4,7 @@
 #include <cdk/targets/basic_target.h>
 #include <cdk/ast/basic_node.h>
 #include "targets/postfix_writer.h"
-
-#include <cdk/emitters/postfix_ix86_emitter.h>
+#include "targets/postfix_sse2_emitter.h"
 
 namespace til {
 
@@ -23,12 +22,14 @@ namespace til {
       // during code generation
       cdk::symbol_table<til::symbol> symtab;
 
-      // this is the backend postfix machine
-      cdk::postfix_ix86_emitter pf(compiler);
+      // this is the backend postfix machine (doubles in SSE2 registers)
+      postfix_sse2_emitter pf(compiler);
 
       // generate assembly code from the syntax tree
       postfix_writer writer(compiler, symtab, pf);
+      writer.start_unit(compiler->ast());
       compiler->ast()->accept(&writer, 0);
+      writer.finish_unit();
 
       return true;
     }
@@ -1,5 +1,6 @@
 #include <string>
 #include <sstream>
+#include <cstdint>
 #include "targets/type_checker.h"
 #include "targets/postfix_writer.h"
 #include "targets/frame_size_calculator.h"
@@ -8,6 +9,12 @@
 
 void til::postfix_writer::accept_covariant_node(std::shared_ptr<cdk::basic_type> const target_type, cdk::expression_node * const node, int lvl) {
   if (target_type->name() != cdk::TYPE_FUNCTIONAL || !node->is_typed(cdk::TYPE_FUNCTIONAL)) {
+    auto integer = dynamic_cast<cdk::integer_node*>(node);
+    if (target_type->name() == cdk::TYPE_DOUBLE && integer) {
+      cdk::double_node converted(integer->lineno(), integer->value()); // converted at compile time
+      converted.accept(this, lvl);
+      return;
+    }
     node->accept(this, lvl);
     if (target_type->name() == cdk::TYPE_DOUBLE && node->is_typed(cdk::TYPE_INT)) {
       _pf.I2D();
@@ -34,50 +41,124 @@ void til::postfix_writer::accept_covariant_node(std::shared_ptr<cdk::basic_type>
     return;
   }
 
-  auto lineno = node->lineno();
-  auto aux_global_decl_name = "_wrapper_target_" + std::to_string(_lbl++);
-  auto aux_global_decl = new til::declaration_node(lineno, tPRIVATE, rfunc_type, aux_global_decl_name, nullptr);
-  auto aux_global_var = new cdk::variable_node(lineno, aux_global_decl_name);
+  // one wrapper per conversion and target: literals, external functions and
+  // constant globals are called directly and share it; any other target is
+  // kept in a global of its own for each conversion, since the variable may
+  // be assigned between two of them
+  auto rvalue = dynamic_cast<cdk::rvalue_node*>(node);
+  auto variable = rvalue ? dynamic_cast<cdk::variable_node*>(rvalue->lvalue()) : nullptr;
+  auto symbol = variable ? _symtab.find(variable->name()) : nullptr;
+  bool direct = isInstanceOf<til::function_definition_node>(node) || (symbol && symbol->qualifier() == tEXTERNAL)
+      || direct_target(node);
+
+  std::ostringstream key;
+  key << cdk::to_string(lfunc_type) << " <- " << cdk::to_string(rfunc_type) << " ";
+  if (direct && symbol && symbol->global()) {
+    key << symbol->name();
+  } else {
+    key << node;
+  }
 
-  _outside_func = true;
-  aux_global_decl->accept(this, lvl);
-  _outside_func = false;
+  auto wrapper = _wrappers.find(key.str());
+  if (wrapper == _wrappers.end()) {
+    auto lineno = node->lineno();
+    cdk::expression_node *target = node;
+    std::string target_slot;
+
+    if (!direct) {
+      target_slot = "_wrapper_target_" + std::to_string(_lbl++);
+      auto aux_global_decl = new til::declaration_node(lineno, tPRIVATE, rfunc_type, target_slot, nullptr);
+      _outside_func = true;
+      aux_global_decl->accept(this, lvl);
+      _outside_func = false;
+      target = new cdk::rvalue_node(lineno, new cdk::variable_node(lineno, target_slot));
+    }
 
+    auto args = new cdk::sequence_node(lineno);
+    auto call_args = new cdk::sequence_node(lineno);
+    for (size_t i = 0; i < lfunc_type->input_length(); i++) {
+      auto arg_name = "_arg" + std::to_string(i);
 
-  if (!_function_labels.empty() && !_outside_func) {
+      auto arg_decl = new til::declaration_node(lineno, tPRIVATE, lfunc_type->input(i), arg_name, nullptr);
+      args = new cdk::sequence_node(lineno, arg_decl, args);
+
+      auto arg_rvalue = new cdk::rvalue_node(lineno, new cdk::variable_node(lineno, arg_name));
+      call_args = new cdk::sequence_node(lineno, arg_rvalue, call_args);
+    }
+
+    auto function_call = new til::function_call_node(lineno, target, call_args);
+    auto return_node = new til::return_node(lineno, function_call);
+    auto block = new til::block_node(lineno, new cdk::sequence_node(lineno), new cdk::sequence_node(lineno, return_node));
+
+    auto wrapping_function = new til::function_definition_node(lineno, lfunc_type->output(0), args, block);
+    CHECK_TYPES(_compiler, _symtab, wrapping_function);
+    auto wrapper_label = define_function(wrapping_function, lvl);
+
+    wrapper = _wrappers.emplace(key.str(), std::make_pair(wrapper_label, target_slot)).first;
+  }
+
+  auto &target_slot = wrapper->second.second;
+  if (!target_slot.empty() && !_function_labels.empty()) {
+    // the target may change between conversions
     _pf.TEXT(_function_labels.top());
-  } else {
-    _pf.DATA();
+    node->accept(this, lvl);
+    _pf.ADDR(target_slot);
+    _pf.STINT();
   }
-  _pf.ALIGN();
+  function_address(wrapper->second.first);
+}
 
-  // we can't pass the target function as an initializer to the declaration, as it
-  // may be a non-literal expression, so we need to assign it afterwards
-  auto aux_global_assignment = new cdk::assignment_node(lineno, aux_global_var, node);
-  aux_global_assignment->accept(this, lvl);
+//---------------------------------------------------------------------------
 
-  auto aux_global_rvalue = new cdk::rvalue_node(lineno, aux_global_var);
-  //! </aux global declaration and assignment>
+void til::postfix_writer::open_cse(cdk::basic_node * const node, int lvl) {
+  _cse = std::make_shared<value_numbering>(_compiler);
+  _cse_offset = _offset;
+  node->accept(_cse.get(), lvl);
 
-  auto args = new cdk::sequence_node(lineno);
-  auto call_args = new cdk::sequence_node(lineno);
-  for (size_t i = 0; i < lfunc_type->input_length(); i++) {
-    auto arg_name = "_arg" + std::to_string(i);
+  for (auto &value : _cse->repeated()) {
+    _offset -= 8; // one slot per value (see frame_size_calculator)
+    _cse_slots[value] = _offset;
+  }
+}
+
+void til::postfix_writer::close_cse() {
+  if (_cse) _offset = _cse_offset; // the slots are free for the next statement
+  _cse = nullptr;
+  _cse_slots.clear();
+  _cse_ready.clear();
+}
 
-    auto arg_decl = new til::declaration_node(lineno, tPRIVATE, lfunc_type->input(i), arg_name, nullptr);
-    args = new cdk::sequence_node(lineno, arg_decl, args);
+bool til::postfix_writer::reuse_value(cdk::basic_node * const node, size_t size) {
+  if (!_cse) return false;
 
-    auto arg_rvalue = new cdk::rvalue_node(lineno, new cdk::variable_node(lineno, arg_name));
-    call_args = new cdk::sequence_node(lineno, arg_rvalue, call_args);
+  auto value = _cse->repeated(node);
+  if (!value || !_cse_ready.count(*value)) return false;
+
+  _pf.LOCAL(_cse_slots[*value]);
+  if (size == 8) {
+    _pf.LDDOUBLE();
+  } else {
+    _pf.LDINT();
   }
+  return true;
+}
 
-  auto function_call = new til::function_call_node(lineno, aux_global_rvalue, call_args);
-  auto return_node = new til::return_node(lineno, function_call);
-  auto block = new til::block_node(lineno, new cdk::sequence_node(lineno), new cdk::sequence_node(lineno, return_node));
+void til::postfix_writer::keep_value(cdk::basic_node * const node, size_t size) {
+  if (!_cse || _cse_conditional > 0) return; // the first computation must always execute
 
-  auto wrapping_function = new til::function_definition_node(lineno, lfunc_type->output(0), args, block);
+  auto value = _cse->repeated(node);
+  if (!value || _cse_ready.count(*value)) return;
 
-  wrapping_function->accept(this, lvl);
+  if (size == 8) {
+    _pf.DUP64();
+    _pf.LOCAL(_cse_slots[*value]);
+    _pf.STDOUBLE();
+  } else {
+    _pf.DUP32();
+    _pf.LOCAL(_cse_slots[*value]);
+    _pf.STINT();
+  }
+  _cse_ready.insert(*value);
 }
 
 //---------------------------------------------------------------------------
@@ -107,21 +188,45 @@ void til::postfix_writer::do_integer_node(cdk::integer_node * const node, int lv
   }
 }
 
+/** A name for debuggers: til_fn_ followed by the variable holding the function (or its line). */
+std::string til::postfix_writer::function_symbol(til::function_definition_node * const node) {
+  auto name = _function_names.find(node);
+  auto symbol = "til_fn_" + (name != _function_names.end() ? name->second : std::to_string(node->lineno()));
+  auto unique = symbol;
+  for (int i = 2; !_symbols.insert(unique).second; i++) {
+    unique = symbol + "_" + std::to_string(i);
+  }
+  return unique;
+}
+
+/** Attribute the code that follows to the line of a node (with --debug). */
+void til::postfix_writer::source_line(cdk::basic_node * const node) {
+  source_line(node->lineno());
+}
+
+/** Attribute the code that follows to a source line (with --debug). */
+void til::postfix_writer::source_line(int line) {
+  if (!debug() || line == _line) return;
+  _line = line;
+  os() << "%line " << _line << "+0 " << _compiler->ifile() << "\n"; // a yasm directive, not an instruction
+}
+
+/** The label of a string literal (emitted with the unit's other strings). */
+std::string til::postfix_writer::string_label(const std::string &value) {
+  auto it = _strings.find(value);
+  if (it == _strings.end()) {
+    it = _strings.emplace(value, mklbl(++_lbl)).first;
+  }
+  return it->second;
+}
+
 void til::postfix_writer::do_string_node(cdk::string_node * const node, int lvl) {
-  int lbl1;
-  /* generate the string literal */
-  _pf.RODATA(); // strings are readonly DATA
-  _pf.ALIGN(); // make sure the address is aligned
-  _pf.LABEL(mklbl(lbl1 = ++_lbl)); // give the string a name
-  _pf.SSTRING(node->value()); // output string characters
   if (!_function_labels.empty() && !_outside_func) {
     // local variable initializer
-    _pf.TEXT(_function_labels.top());
-    _pf.ADDR(mklbl(lbl1));
+    _pf.ADDR(string_label(node->value()));
   } else {
     // global variable initializer
-    _pf.DATA();
-    _pf.SADDR(mklbl(lbl1));
+    _pf.SADDR(string_label(node->value()));
   }
 }
 
@@ -137,12 +242,14 @@ void til::postfix_writer::do_double_node(cdk::double_node * const node, int lvl)
 
 void til::postfix_writer::do_unary_minus_node(cdk::unary_minus_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, value_size(node))) return;
   node->argument()->accept(this, lvl); // determine the value
   if (node->is_typed(cdk::TYPE_DOUBLE)) {
     _pf.DNEG();
   } else {
     _pf.NEG();
   }
+  keep_value(node, value_size(node));
 }
 
 void til::postfix_writer::do_unary_plus_node(cdk::unary_plus_node * const node, int lvl) {
@@ -152,16 +259,19 @@ void til::postfix_writer::do_unary_plus_node(cdk::unary_plus_node * const node,
 
 void til::postfix_writer::do_not_node(cdk::not_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
 
   node->argument()->accept(this, lvl);
   _pf.INT(0);
   _pf.EQ();
+  keep_value(node, 4);
 }
 
 //---------------------------------------------------------------------------
 
 void til::postfix_writer::do_add_node(cdk::add_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, value_size(node))) return;
 
   node->left()->accept(this, lvl);
   if (node->is_typed(cdk::TYPE_DOUBLE) && node->left()->is_typed(cdk::TYPE_INT)) {
@@ -186,9 +296,11 @@ void til::postfix_writer::do_add_node(cdk::add_node * const node, int lvl) {
   } else {
     _pf.ADD();
   }
+  keep_value(node, value_size(node));
 }
 void til::postfix_writer::do_sub_node(cdk::sub_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, value_size(node))) return;
 
   node->left()->accept(this, lvl);
   if (node->is_typed(cdk::TYPE_DOUBLE) && node->left()->is_typed(cdk::TYPE_INT)) {
@@ -220,6 +332,7 @@ void til::postfix_writer::do_sub_node(cdk::sub_node * const node, int lvl) {
     _pf.INT(std::max(static_cast<size_t>(1), lref->referenced()->size()));
     _pf.DIV();
   }
+  keep_value(node, value_size(node));
 }
 
 //mudar nome
@@ -238,6 +351,8 @@ void til::postfix_writer::prepareIDBinaryExpression(cdk::binary_operation_node *
 }
 
 void til::postfix_writer::do_mul_node(cdk::mul_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, value_size(node))) return;
   prepareIDBinaryExpression(node, lvl);
   
   if (node->is_typed(cdk::TYPE_DOUBLE)) {
@@ -245,8 +360,107 @@ void til::postfix_writer::do_mul_node(cdk::mul_node * const node, int lvl) {
   } else {
     _pf.MUL();
   }
+  keep_value(node, value_size(node));
+}
+/** The k such that a constant divisor is 2^k, k > 0 (if it is one). */
+/** The value of a divisor known at compile time, if it is a literal greater than 1 (or a constant parameter). */
+std::optional<int> til::postfix_writer::constant_divisor(cdk::expression_node * const divisor) {
+  cdk::expression_node *value = divisor;
+  if (auto rvalue = dynamic_cast<cdk::rvalue_node*>(divisor)) value = constant_parameter(rvalue);
+  auto literal = dynamic_cast<cdk::integer_node*>(value);
+  if (!literal || literal->value() < 2) return std::nullopt;
+  return literal->value();
+}
+
+std::optional<int> til::postfix_writer::power_of_two(cdk::expression_node * const divisor) {
+  auto d = constant_divisor(divisor);
+  if (!d || (*d & (*d - 1)) != 0) return std::nullopt;
+
+  int k = 0;
+  while ((1 << k) != *d) k++;
+  return k;
+}
+
+/**
+ * Replace the dividend on top of the stack by its quotient by d (greater
+ * than 2, not a power of two), rounded towards zero as IDIV does: the high
+ * half of its product by a magic number, shifted, plus one if negative
+ * (Hacker's Delight, 10-4).
+ */
+void til::postfix_writer::divide_by_constant(int d) {
+  const uint32_t two31 = 0x80000000u, ad = d;
+  uint32_t anc = two31 - 1 - two31 % ad;
+  uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+  uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+  int p = 31;
+  uint32_t delta;
+  do {
+    p++;
+    q1 *= 2;
+    r1 *= 2;
+    if (r1 >= anc) {
+      q1++;
+      r1 -= anc;
+    }
+    q2 *= 2;
+    r2 *= 2;
+    if (r2 >= ad) {
+      q2++;
+      r2 -= ad;
+    }
+    delta = ad - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+  auto magic = static_cast<int32_t>(q2 + 1);
+
+  _pf.DUP32();
+  if (magic < 0) _pf.DUP32(); // the product is off by the dividend
+  _pf.INT(magic);
+  _pf.MULHI();
+  if (magic < 0) _pf.ADD();
+  if (p > 32) {
+    _pf.INT(p - 32);
+    _pf.SHTRS();
+  }
+  _pf.SWAP32();
+  _pf.INT(31);
+  _pf.SHTRU(); // 1 if negative, 0 otherwise
+  _pf.ADD();
+}
+
+/**
+ * Turn the dividend on top of the stack into dividend + 2^k - 1 when it is
+ * negative, so that shifting and masking round towards zero, as IDIV does.
+ */
+void til::postfix_writer::round_towards_zero(int k) {
+  _pf.DUP32();
+  _pf.INT(31);
+  _pf.SHTRS(); // -1 if negative, 0 otherwise
+  _pf.INT(32 - k);
+  _pf.SHTRU(); // 2^k - 1 if negative, 0 otherwise
+  _pf.ADD();
 }
+
 void til::postfix_writer::do_div_node(cdk::div_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, value_size(node))) return;
+
+  auto k = node->is_typed(cdk::TYPE_INT) ? power_of_two(node->right()) : std::nullopt;
+  if (k) {
+    node->left()->accept(this, lvl);
+    round_towards_zero(*k);
+    _pf.INT(*k);
+    _pf.SHTRS();
+    keep_value(node, 4);
+    return;
+  }
+  auto d = node->is_typed(cdk::TYPE_INT) ? constant_divisor(node->right()) : std::nullopt;
+  if (d) {
+    node->left()->accept(this, lvl);
+    divide_by_constant(*d);
+    keep_value(node, 4);
+    return;
+  }
+
   prepareIDBinaryExpression(node, lvl);
 
   if (node->is_typed(cdk::TYPE_DOUBLE)) {
@@ -254,13 +468,38 @@ void til::postfix_writer::do_div_node(cdk::div_node * const node, int lvl) {
   } else {
     _pf.DIV();
   }
+  keep_value(node, value_size(node));
 }
 
 void til::postfix_writer::do_mod_node(cdk::mod_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
   node->left()->accept(this, lvl);
+
+  if (auto k = power_of_two(node->right())) {
+    // x - (x / 2^k) * 2^k: the remainder keeps the dividend's sign
+    _pf.DUP32();
+    round_towards_zero(*k);
+    _pf.INT(-(1 << *k));
+    _pf.AND();
+    _pf.SUB();
+    keep_value(node, 4);
+    return;
+  }
+  if (auto d = constant_divisor(node->right())) {
+    // x - (x / d) * d
+    _pf.DUP32();
+    divide_by_constant(*d);
+    _pf.INT(*d);
+    _pf.MUL();
+    _pf.SUB();
+    keep_value(node, 4);
+    return;
+  }
+
   node->right()->accept(this, lvl);
   _pf.MOD();
+  keep_value(node, 4);
 }
 
 void til::postfix_writer::prepareIDBinaryComparisonExpression(cdk::binary_operation_node * const node, int lvl) {
@@ -272,52 +511,165 @@ void til::postfix_writer::prepareIDBinaryComparisonExpression(cdk::binary_operat
   }
 }
 
+/** Branch on the condition of a statement, reusing its repeated values. */
+void til::postfix_writer::test(cdk::expression_node * const condition, bool when, const std::string &target, int lvl) {
+  open_cse(condition, lvl);
+  branch(condition, when, target, lvl);
+  close_cse();
+}
+
+/** Jump to target when the condition's value is when, without computing 0 or 1. */
+void til::postfix_writer::branch(cdk::expression_node * const condition, bool when, const std::string &target, int lvl) {
+  // repeated values must be computed where they first appear (see value_numbering)
+  if (_cse && _cse->repeated(condition)) {
+    condition->accept(this, lvl);
+    if (when) {
+      _pf.JNZ(target);
+    } else {
+      _pf.JZ(target);
+    }
+    return;
+  }
+
+  if (auto literal = dynamic_cast<cdk::integer_node*>(condition)) {
+    if ((literal->value() != 0) == when) _pf.JMP(target);
+    return;
+  }
+
+  if (auto negation = dynamic_cast<cdk::not_node*>(condition)) {
+    branch(negation->argument(), !when, target, lvl);
+    return;
+  }
+
+  if (isInstanceOf<cdk::and_node, cdk::or_node>(condition)) {
+    auto operation = dynamic_cast<cdk::binary_operation_node*>(condition);
+    bool decisive = isInstanceOf<cdk::or_node>(condition); // left value that decides the result
+    if (when == decisive) {
+      branch(operation->left(), when, target, lvl);
+      _cse_conditional++;
+      branch(operation->right(), when, target, lvl);
+      _cse_conditional--;
+    } else {
+      int lbl;
+      branch(operation->left(), decisive, mklbl(lbl = ++_lbl), lvl); // short circuit
+      _cse_conditional++;
+      branch(operation->right(), when, target, lvl);
+      _cse_conditional--;
+      _pf.ALIGN();
+      _pf.LABEL(mklbl(lbl));
+    }
+    return;
+  }
+
+  auto comparison = dynamic_cast<cdk::binary_operation_node*>(condition);
+  if (isInstanceOf<cdk::lt_node, cdk::le_node, cdk::gt_node, cdk::ge_node, cdk::eq_node, cdk::ne_node>(condition)) {
+    prepareIDBinaryComparisonExpression(comparison, lvl);
+    if (isInstanceOf<cdk::lt_node>(condition)) {
+      when ? _pf.JLT(target) : _pf.JGE(target);
+    } else if (isInstanceOf<cdk::le_node>(condition)) {
+      when ? _pf.JLE(target) : _pf.JGT(target);
+    } else if (isInstanceOf<cdk::gt_node>(condition)) {
+      when ? _pf.JGT(target) : _pf.JLE(target);
+    } else if (isInstanceOf<cdk::ge_node>(condition)) {
+      when ? _pf.JGE(target) : _pf.JLT(target);
+    } else if (isInstanceOf<cdk::eq_node>(condition)) {
+      when ? _pf.JEQ(target) : _pf.JNE(target);
+    } else {
+      when ? _pf.JNE(target) : _pf.JEQ(target);
+    }
+    return;
+  }
+
+  condition->accept(this, lvl);
+  if (when) {
+    _pf.JNZ(target);
+  } else {
+    _pf.JZ(target);
+  }
+}
+
 void til::postfix_writer::do_lt_node(cdk::lt_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
   prepareIDBinaryComparisonExpression(node, lvl);
   _pf.LT();
+  keep_value(node, 4);
 }
 void til::postfix_writer::do_le_node(cdk::le_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
   prepareIDBinaryComparisonExpression(node, lvl);
   _pf.LE();
+  keep_value(node, 4);
 }
 void til::postfix_writer::do_ge_node(cdk::ge_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
   prepareIDBinaryComparisonExpression(node, lvl);
   _pf.GE();
+  keep_value(node, 4);
 }
 void til::postfix_writer::do_gt_node(cdk::gt_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
   prepareIDBinaryComparisonExpression(node, lvl);
   _pf.GT();
+  keep_value(node, 4);
 }
 void til::postfix_writer::do_ne_node(cdk::ne_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
   prepareIDBinaryComparisonExpression(node, lvl);
   _pf.NE();
+  keep_value(node, 4);
 }
 void til::postfix_writer::do_eq_node(cdk::eq_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
   prepareIDBinaryComparisonExpression(node, lvl);
   _pf.EQ();
+  keep_value(node, 4);
 }
 
 void til::postfix_writer::do_and_node(cdk::and_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
+  // 0 or 1, as when branching on it (see branch)
   int lbl;
   node->left()->accept(this, lvl);
+  _pf.INT(0);
+  _pf.NE();
   _pf.DUP32();
   _pf.JZ(mklbl(lbl = ++_lbl)); // short circuit
+  _pf.TRASH(4);
+  _cse_conditional++;
   node->right()->accept(this, lvl);
-  _pf.AND();
+  _cse_conditional--;
+  _pf.INT(0);
+  _pf.NE();
   _pf.ALIGN();
   _pf.LABEL(mklbl(lbl));
+  keep_value(node, 4);
 }
 void til::postfix_writer::do_or_node(cdk::or_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return;
+  // 0 or 1, as when branching on it (see branch)
   int lbl;
   node->left()->accept(this, lvl);
+  _pf.INT(0);
+  _pf.NE();
   _pf.DUP32();
   _pf.JNZ(mklbl(lbl = ++_lbl)); // short circuit
+  _pf.TRASH(4);
+  _cse_conditional++;
   node->right()->accept(this, lvl);
-  _pf.OR();
+  _cse_conditional--;
+  _pf.INT(0);
+  _pf.NE();
   _pf.ALIGN();
   _pf.LABEL(mklbl(lbl));
+  keep_value(node, 4);
 }
 
 //---------------------------------------------------------------------------
@@ -336,8 +688,29 @@ void til::postfix_writer::do_variable_node(cdk::variable_node * const node, int
   }
 }
 
+/** The literal that every call passes to a parameter of the current function (if any). */
+cdk::expression_node *til::postfix_writer::constant_parameter(cdk::rvalue_node * const node) {
+  auto variable = dynamic_cast<cdk::variable_node*>(node->lvalue());
+  auto symbol = variable ? _symtab.find(variable->name()) : nullptr;
+  if (!_function || !symbol || symbol->offset() <= 0) return nullptr;
+
+  auto arguments = _function->arguments();
+  for (size_t i = 0; i < arguments->size(); i++) {
+    auto argument = dynamic_cast<til::declaration_node*>(arguments->node(i));
+    if (argument && argument->identifier() == variable->name()) return _constants->constant_argument(_function, i);
+  }
+  return nullptr;
+}
+
 void til::postfix_writer::do_rvalue_node(cdk::rvalue_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, value_size(node))) return;
+
+  if (auto value = constant_parameter(node)) {
+    accept_covariant_node(node->type(), value, lvl);
+    return;
+  }
+
   node->lvalue()->accept(this, lvl);
 
   if (_external_func_name) 
@@ -348,6 +721,7 @@ void til::postfix_writer::do_rvalue_node(cdk::rvalue_node * const node, int lvl)
   } else {
     _pf.LDINT();
   }
+  keep_value(node, value_size(node));
 }
 
 void til::postfix_writer::do_assignment_node(cdk::assignment_node * const node, int lvl) {
@@ -372,8 +746,11 @@ void til::postfix_writer::do_assignment_node(cdk::assignment_node * const node,
 
 void til::postfix_writer::do_evaluation_node(til::evaluation_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
 
+  open_cse(node, lvl);
   node->argument()->accept(this, lvl);
+  close_cse();
 
   if (node->argument()->type()->size() > 0) {
     _pf.TRASH(node->argument()->type()->size());
@@ -382,10 +759,23 @@ void til::postfix_writer::do_evaluation_node(til::evaluation_node * const node,
 
 void til::postfix_writer::do_print_node(til::print_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
   
+  std::string text; // consecutive literals are printed by a single call
+  open_cse(node, lvl);
   for (size_t ix = 0; ix < node->expressions()->size(); ix++) {
     auto child = dynamic_cast<cdk::expression_node*>(node->expressions()->node(ix));
 
+    if (auto literal = dynamic_cast<cdk::string_node*>(child)) {
+      text += literal->value();
+      continue;
+    } else if (auto literal = dynamic_cast<cdk::integer_node*>(child)) {
+      text += std::to_string(literal->value());
+      continue;
+    }
+    print_text(text, node->lineno(), lvl);
+    text.clear();
+
     child->accept(this, lvl);
     if (child->is_typed(cdk::TYPE_INT)) {
       _external_func_to_declare.insert("printi");
@@ -401,18 +791,55 @@ void til::postfix_writer::do_print_node(til::print_node * const node, int lvl) {
       _pf.TRASH(8); // delete the printed value
     }
   }
+  close_cse();
 
-  if (node->newline()) {
+  if (node->newline() && text.empty()) {
     _external_func_to_declare.insert("println");
     _pf.CALL("println");
+  } else {
+    print_text(node->newline() ? text + "\n" : text, node->lineno(), lvl);
   }
   
 }
 
+void til::postfix_writer::print_text(const std::string &text, int lineno, int lvl) {
+  if (text.empty()) return;
+  cdk::string_node literal(lineno, text);
+  literal.accept(this, lvl);
+  _external_func_to_declare.insert("prints");
+  _pf.CALL("prints");
+  _pf.TRASH(4); // delete the printed value's address
+}
+
 //---------------------------------------------------------------------------
 
 void til::postfix_writer::do_read_node(til::read_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (node->count()) {
+    auto ref = cdk::reference_type::cast(node->type())->referenced();
+    bool doubles = ref->name() == cdk::TYPE_DOUBLE;
+    if (!doubles && ref->name() != cdk::TYPE_INT && ref->name() != cdk::TYPE_UNSPEC) {
+      THROW_ERROR("only vectors of int or double can be read");
+    }
+
+    // allocate the vector and let the unit's helper fill (and return) it
+    node->count()->accept(this, lvl);
+    _pf.DUP32();
+    heap_allocate(doubles ? 8 : 4);
+    if (doubles) {
+      _external_func_to_declare.insert("readd");
+      _reads_doubles = true;
+      _pf.CALL("_read_doubles");
+    } else {
+      _external_func_to_declare.insert("readi");
+      _reads_ints = true;
+      _pf.CALL("_read_ints");
+    }
+    _pf.TRASH(8);
+    _pf.LDFVAL32();
+    return;
+  }
+
   if(node->is_typed(cdk::TYPE_DOUBLE)) {
     _external_func_to_declare.insert("readd");
     _pf.CALL("readd");
@@ -428,28 +855,59 @@ void til::postfix_writer::do_read_node(til::read_node * const node, int lvl) {
 
 void til::postfix_writer::do_loop_node(til::loop_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
-  int condlbl, endlbl;
-  _pf.LABEL(mklbl(condlbl = ++_lbl));
-  node->condition()->accept(this, lvl);
-  _pf.JZ(mklbl(endlbl = ++_lbl));
+  source_line(node);
+  // the condition is tested before entering and then at the bottom, so
+  // that each iteration takes a single jump
+  int bodylbl, condlbl, endlbl;
+  test(node->condition(), false, mklbl(endlbl = ++_lbl), lvl);
+  _pf.ALIGN();
+  _pf.LABEL(mklbl(bodylbl = ++_lbl));
 
-  _cur_func_loop_labels->push_back(std::make_pair(mklbl(condlbl), mklbl(endlbl)));
+  _cur_func_loop_labels->push_back(std::make_pair(mklbl(condlbl = ++_lbl), mklbl(endlbl)));
   node->instruction()->accept(this, lvl + 2);
   _loop_ended = false; 
   _cur_func_loop_labels->pop_back();
 
-  _pf.JMP(mklbl(condlbl));
+  _pf.ALIGN();
+  _pf.LABEL(mklbl(condlbl));
+  source_line(node);
+  test(node->condition(), true, mklbl(bodylbl), lvl);
   _pf.ALIGN();
   _pf.LABEL(mklbl(endlbl));
 }
 
+/**
+ * Repeat step while counter < bound. The step advances the counter by one,
+ * so, when the bound does not change, it is repeated TIL_UNROLL_FACTOR
+ * times per test, and a second loop does the remaining iterations.
+ */
+void til::postfix_writer::counted_loop(cdk::variable_node * const counter, cdk::expression_node * const bound,
+                                       cdk::sequence_node * const step, bool unroll, int lvl) {
+  auto lineno = step->lineno();
+
+  if (unroll && TIL_UNROLL_FACTOR > 1) {
+    auto steps = new cdk::sequence_node(lineno, step);
+    for (int i = 1; i < TIL_UNROLL_FACTOR; i++) {
+      steps = new cdk::sequence_node(lineno, step, steps);
+    }
+    auto last = new cdk::add_node(lineno, new cdk::rvalue_node(lineno, counter),
+        new cdk::integer_node(lineno, TIL_UNROLL_FACTOR - 1));
+    auto unrolled = new til::loop_node(lineno, new cdk::lt_node(lineno, last, bound), steps);
+    unrolled->accept(this, lvl);
+  }
+
+  auto remainder = new til::loop_node(lineno,
+      new cdk::lt_node(lineno, new cdk::rvalue_node(lineno, counter), bound), step);
+  remainder->accept(this, lvl);
+}
+
 //---------------------------------------------------------------------------
 
 void til::postfix_writer::do_if_node(til::if_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
   int lbl1;
-  node->condition()->accept(this, lvl);
-  _pf.JZ(mklbl(lbl1 = ++_lbl));
+  test(node->condition(), false, mklbl(lbl1 = ++_lbl), lvl);
   node->block()->accept(this, lvl + 2);
   _loop_ended = false;
   _pf.ALIGN();
@@ -460,9 +918,9 @@ void til::postfix_writer::do_if_node(til::if_node * const node, int lvl) {
 
 void til::postfix_writer::do_if_else_node(til::if_else_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
   int lbl1, lbl2;
-  node->condition()->accept(this, lvl);
-  _pf.JZ(mklbl(lbl1 = ++_lbl));
+  test(node->condition(), false, mklbl(lbl1 = ++_lbl), lvl);
   node->thenblock()->accept(this, lvl + 2);
   _loop_ended = false; 
   _pf.JMP(mklbl(lbl2 = ++_lbl));
@@ -486,18 +944,25 @@ void til::postfix_writer::do_null_node(til::null_node * const node, int lvl) {
 
 void til::postfix_writer::do_return_node(til::return_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
 
   auto symbol = _symtab.find("@", 1);
   auto rettype = cdk::functional_type::cast(symbol->type())->output(0);
   auto rettype_name = rettype->name();
 
   if (rettype_name != cdk::TYPE_VOID) {
+    open_cse(node, lvl);
     accept_covariant_node(rettype, node->retval(), lvl + 2);
+    close_cse();
+    if (_memo) remember();
+    function_epilogue();
     if (rettype_name == cdk::TYPE_DOUBLE) {
       _pf.STFVAL64();
     } else {
       _pf.STFVAL32();
     }
+  } else {
+    function_epilogue();
   }
   _pf.JMP(_current_func_ret_label);
 
@@ -511,6 +976,7 @@ void til::postfix_writer::do_address_of_node(til::address_of_node * const node,
 
 void til::postfix_writer::do_block_node(til::block_node * const node, int lvl) {
    _symtab.push(); // for block-local variables
+  int block_offset = _offset; // sibling blocks share slots (see frame_size_calculator)
   node->declarations()->accept(this, lvl + 2);
 
   _loop_ended = false;
@@ -525,6 +991,7 @@ void til::postfix_writer::do_block_node(til::block_node * const node, int lvl) {
   }
   _loop_ended = false;
 
+  _offset = block_offset;
   _symtab.pop();
 }
 
@@ -539,6 +1006,12 @@ void til::postfix_writer::do_function_call_node(til::function_call_node * const
     func_type = cdk::functional_type::cast(node->func()->type());
   }
 
+  if (auto value = constant_call(node)) {
+    cdk::integer_node literal(node->lineno(), *value);
+    literal.accept(this, lvl);
+    return;
+  }
+
   size_t args_size = 0;
   for (size_t i = node->arguments()->size(); i > 0; i--) {
     auto arg = dynamic_cast<cdk::expression_node*>(node->arguments()->node(i - 1));
@@ -550,6 +1023,13 @@ void til::postfix_writer::do_function_call_node(til::function_call_node * const
   _external_func_name = std::nullopt;
   if (!node->func()) { 
     _pf.ADDR(_function_labels.top());
+  } else if (auto literal = dynamic_cast<til::function_definition_node*>(node->func())) {
+    // literals are called by their labels
+    CHECK_TYPES(_compiler, _symtab, literal);
+    _external_func_name = define_function(literal, lvl);
+    _pf.TEXT(_function_labels.top());
+  } else if (auto label = direct_target(node->func())) {
+    _external_func_name = label;
   } else {
     node->func()->accept(this, lvl);
   }
@@ -574,21 +1054,112 @@ void til::postfix_writer::do_function_call_node(til::function_call_node * const
 
 void til::postfix_writer::do_function_definition_node(til::function_definition_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
-  
+  auto function_label = define_function(node, lvl);
+
+  if (node->is_main()) {
+    for (std::string s : _external_func_to_declare) {
+      _pf.EXTERN(s);
+    }
+    return;
+  }
+
+  function_address(function_label);
+}
+
+std::string til::postfix_writer::literal_label(til::function_definition_node * const node) {
+  auto it = _literal_labels.find(node);
+  if (it == _literal_labels.end()) {
+    it = _literal_labels.emplace(node, mklbl(++_lbl)).first;
+  }
+  return it->second;
+}
+
+std::optional<std::string> til::postfix_writer::direct_target(cdk::expression_node * const node) {
+  auto rvalue = dynamic_cast<cdk::rvalue_node*>(node);
+  auto variable = rvalue ? dynamic_cast<cdk::variable_node*>(rvalue->lvalue()) : nullptr;
+  if (!variable || !_constants) return std::nullopt;
+
+  auto symbol = _symtab.find(variable->name());
+  auto literal = _constants->literal(variable->name());
+  if (!symbol || !symbol->global() || !literal) return std::nullopt;
+  return literal_label(literal);
+}
+
+/** The value of a call to a pure function whose arguments are all known (if it can be computed). */
+std::optional<int> til::postfix_writer::constant_call(til::function_call_node * const node) {
+  if (!_evaluator || !node->func() || !node->is_typed(cdk::TYPE_INT)) return std::nullopt;
+
+  auto function = dynamic_cast<til::function_definition_node*>(node->func());
+  auto rvalue = dynamic_cast<cdk::rvalue_node*>(node->func());
+  auto variable = rvalue ? dynamic_cast<cdk::variable_node*>(rvalue->lvalue()) : nullptr;
+  if (variable) {
+    auto symbol = _symtab.find(variable->name());
+    if (symbol && symbol->global()) function = _constants->literal(variable->name());
+  }
+  if (!function) return std::nullopt;
+
+  std::vector<int> arguments;
+  for (size_t i = 0; i < node->arguments()->size(); i++) {
+    auto argument = dynamic_cast<cdk::expression_node*>(node->arguments()->node(i));
+    if (auto parameter = dynamic_cast<cdk::rvalue_node*>(argument)) argument = constant_parameter(parameter);
+    auto value = dynamic_cast<cdk::integer_node*>(argument);
+    if (!value) return std::nullopt;
+    arguments.push_back(value->value());
+  }
+  return _evaluator->call(function, arguments);
+}
+
+void til::postfix_writer::function_address(const std::string &label) {
+  if (!_function_labels.empty() && !_outside_func) {
+    _pf.TEXT(_function_labels.top());
+    _pf.ADDR(label);
+  } else {
+    _pf.DATA();
+    _pf.SADDR(label);
+  }
+}
+
+std::string til::postfix_writer::define_function(til::function_definition_node * const node, int lvl) {
   std::string function_label;
   if (node->is_main()) {
     function_label = "_main";
   } else {
-    function_label = mklbl(++_lbl);
+    function_label = literal_label(node);
+    if (!_defined.insert(node).second) return function_label; // in code that was generated twice
   }
   _function_labels.push(function_label);
 
+  auto previous_profile_record = _profile_record;
+  auto previous_profile_slot = _profile_slot;
+  _profile_slot.reset();
+  if (_profiler) {
+    auto name = _function_names.find(node);
+    _profile_record = mklbl(++_lbl);
+    _profiler->PROFILE_RECORD(_profile_record, node->is_main() ? "main"
+        : name != _function_names.end() ? name->second : "function at line " + std::to_string(node->lineno()));
+  }
+
   _pf.TEXT(_function_labels.top());
   _pf.ALIGN();
   if (node->is_main()) _pf.GLOBAL("_main", _pf.FUNC());
   _pf.LABEL(_function_labels.top());
+  auto previous_line = _line;
+  if (debug() && !node->is_main()) _pf.LABEL(function_symbol(node));
+  source_line(node);
 
   int previous_offset = _offset;
+  auto previous_function = _function;
+  _function = node;
+
+  // functions may be generated in the middle of a statement
+  auto previous_cse = _cse;
+  auto previous_cse_slots = _cse_slots;
+  auto previous_cse_ready = _cse_ready;
+  auto previous_cse_conditional = _cse_conditional;
+  auto previous_cse_offset = _cse_offset;
+  close_cse();
+  _cse_conditional = 0;
+
   _offset = 8; 
   _symtab.push();
 
@@ -596,10 +1167,33 @@ void til::postfix_writer::do_function_definition_node(til::function_definition_n
   node->arguments()->accept(this, lvl);
   _inFunctionArgs = false;
 
+  // decide where buffers are allocated: heap buffers are only released on
+  // exit when none escapes and there are no calls (callees may keep their
+  // own), so other functions keep theirs in the frame (see stack_allocated)
+  auto previous_escapes = _escapes;
+  auto previous_heap_mark = _heap_mark;
+  _escapes = std::make_shared<escape_analysis>(_compiler);
+  _escapes->analyse(node);
+  _heap_mark.reset();
+
+  bool uses_heap = false;
+  for (auto allocation : _escapes->allocations()) {
+    auto objects = dynamic_cast<til::objects_node*>(allocation);
+    if (!objects || !stack_allocated(objects)) uses_heap = true;
+  }
+  bool releases_heap = uses_heap && !_escapes->any_escapes() && !_escapes->calls();
+
   // compute stack size to be reserved for local variables
   frame_size_calculator lsc(_compiler, _symtab);
   node->block()->accept(&lsc, lvl);
-  _pf.ENTER(lsc.localsize()); // total stack size reserved for local variables
+  size_t frame_size = lsc.localsize() + (releases_heap ? 4 : 0) + (_profiler ? 16 : 0);
+
+  // leaf functions without arguments or locals need no frame
+  bool frameless = frame_size == 0 && node->arguments()->size() == 0
+      && _escapes->allocations().empty() && !_escapes->calls();
+  if (!frameless) {
+    _pf.ENTER(frame_size); // total stack size reserved for local variables
+  }
   
   auto previous_func_ret_label = _current_func_ret_label;
   _current_func_ret_label = mklbl(++_lbl);
@@ -608,9 +1202,51 @@ void til::postfix_writer::do_function_definition_node(til::function_definition_n
   _cur_func_loop_labels = new std::vector<std::pair<std::string, std::string>>();
 
   _offset = 0;
+  if (releases_heap) {
+    _offset -= 4;
+    _heap_mark = _offset;
+    _pf.ADDR("_heap_top");
+    _pf.LDINT();
+    _pf.LOCAL(*_heap_mark);
+    _pf.STINT();
+  }
+
+  if (_profiler) {
+    _offset -= 16;
+    _profile_slot = _offset;
+    _profiler->PROFILE_ENTER(_profile_record, *_profile_slot);
+  }
+
+  // results already computed are returned at once
+  auto previous_memo = _memo;
+  _memo.reset();
+  memoization memo(_compiler);
+  memo.analyse(node);
+  if (memo.memoizable()) {
+    _memo = mklbl(++_lbl);
+    _memo_tables.push_back(*_memo);
+    std::string compute = mklbl(++_lbl);
+    memo_entry(0);
+    _pf.LDINT();
+    _pf.JZ(compute);
+    memo_entry(4);
+    _pf.LDINT();
+    _pf.LOCAL(8);
+    _pf.LDINT();
+    _pf.JNE(compute);
+    memo_entry(8);
+    _pf.LDINT();
+    function_epilogue();
+    _pf.STFVAL32();
+    _pf.JMP(_current_func_ret_label);
+    _pf.ALIGN();
+    _pf.LABEL(compute);
+  }
 
   node->block()->accept(this, lvl);
+  _memo = previous_memo;
 
+  function_epilogue();
   if (node->is_main()) {
     _pf.INT(0);
     _pf.STFVAL32();
@@ -618,39 +1254,41 @@ void til::postfix_writer::do_function_definition_node(til::function_definition_n
 
   _pf.ALIGN();
   _pf.LABEL(_current_func_ret_label);
-  _pf.LEAVE();
+  if (!frameless) _pf.LEAVE();
   _pf.RET();
 
   delete _cur_func_loop_labels;
   _cur_func_loop_labels = previousFunctionLoopLabels;
   _current_func_ret_label = previous_func_ret_label;
+  _profile_record = previous_profile_record;
+  _profile_slot = previous_profile_slot;
+  if (previous_function && previous_line > 0) {
+    source_line(previous_line); // back in the middle of the enclosing function's statement
+  }
+  _escapes = previous_escapes;
+  _heap_mark = previous_heap_mark;
+  _cse = previous_cse;
+  _cse_slots = previous_cse_slots;
+  _cse_ready = previous_cse_ready;
+  _cse_conditional = previous_cse_conditional;
+  _cse_offset = previous_cse_offset;
   _offset = previous_offset;
+  _function = previous_function;
   _symtab.pop();
   _function_labels.pop();
 
-  if (node->is_main()) {
-    for (std::string s : _external_func_to_declare) {
-      _pf.EXTERN(s);
-    }
-    return;
-  }
-
-  if (!_function_labels.empty() && !_outside_func) {
-    _pf.TEXT(_function_labels.top());
-    _pf.ADDR(function_label);
-  } else {
-    _pf.DATA();
-    _pf.SADDR(function_label);
-  }
+  return function_label;
 }
 
 void til::postfix_writer::do_index_node(til::index_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  if (reuse_value(node, 4)) return; // the element's address
   node->base()->accept(this, lvl + 2);
   node->index()->accept(this, lvl + 2);
   _pf.INT(node->type()->size());
   _pf.MUL();
   _pf.ADD();
+  keep_value(node, 4);
 }
 
 void til::postfix_writer::do_sizeof_node(til::sizeof_node * const node, int lvl) {
@@ -661,11 +1299,309 @@ void til::postfix_writer::do_sizeof_node(til::sizeof_node * const node, int lvl)
 void til::postfix_writer::do_objects_node(til::objects_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
   auto ref = cdk::reference_type::cast(node->type())->referenced();
+  auto size = std::max(static_cast<size_t>(1), ref->size());
   node->argument()->accept(this, lvl);
-  _pf.INT(std::max(static_cast<size_t>(1), ref->size()));
+  if (stack_allocated(node)) {
+    _pf.INT(size);
+    _pf.MUL();
+    _pf.ALLOC();
+    _pf.SP();
+  } else {
+    heap_allocate(size);
+  }
+}
+
+bool til::postfix_writer::stack_allocated(til::objects_node * const node) {
+  if (!_escapes || _escapes->escapes(node)) return false;
+
+  // a function that escapes buffers or calls others never releases its heap
+  // buffers (see define_function), while the frame is released on return
+  if (_escapes->any_escapes() || _escapes->calls()) return true;
+
+  // otherwise only small buffers stay in the frame (the size of elements
+  // is only known once the node is typed: until then, assume the largest)
+  auto count = dynamic_cast<cdk::integer_node*>(node->argument());
+  if (!count || count->value() < 0) return false;
+  auto ref = node->type() ? cdk::reference_type::cast(node->type())->referenced() : nullptr;
+  auto element = ref && ref->name() != cdk::TYPE_UNSPEC ? std::max(static_cast<size_t>(1), ref->size()) : 8;
+  return static_cast<long long>(count->value()) * element <= TIL_STACK_OBJECTS_LIMIT;
+}
+
+void til::postfix_writer::heap_allocate(size_t size) {
+  // the count is on the stack: negative ones (huge, as unsigned) and those
+  // that do not fit in what is left end the program (see heap_exhausted)
+  _pf.DUP32();
+  _pf.ADDR("_heap_top");
+  _pf.LDINT();
+  _pf.ADDR("_heap_base");
+  _pf.SUB();
+  _pf.INT(size);
+  _pf.DIV();
+  _pf.UGT();
+  _pf.JNZ("_heap_exhausted");
+  _external_func_to_declare.insert("prints");
+  _external_func_to_declare.insert("println");
+
+  // the heap grows downwards: round the size up and move its top
+  _pf.INT(size);
+  _pf.MUL();
+  _pf.INT(7);
+  _pf.ADD();
+  _pf.INT(-8);
+  _pf.AND();
+  _pf.NEG();
+  _pf.ADDR("_heap_top");
+  _pf.LDINT();
+  _pf.ADD();
+  _pf.DUP32();
+  _pf.ADDR("_heap_top");
+  _pf.STINT();
+  _uses_heap = true;
+}
+
+void til::postfix_writer::function_epilogue() {
+  if (_heap_mark) {
+    // release the function's buffers
+    _pf.LOCAL(*_heap_mark);
+    _pf.LDINT();
+    _pf.ADDR("_heap_top");
+    _pf.STINT();
+  }
+
+  if (_profile_slot) {
+    _profiler->PROFILE_LEAVE(_profile_record, *_profile_slot, mklbl(++_lbl));
+    if (_function->is_main()) _profiler->PROFILE_DUMP(string_label(TIL_PROFILE_FILE), mklbl(++_lbl));
+  }
+}
+
+void til::postfix_writer::read_vector(const std::string &label, bool doubles) {
+  int cond, end;
+  _pf.TEXT(label);
+  _pf.ALIGN();
+  _pf.LABEL(label);
+  _pf.ENTER(4); // next element
+
+  _pf.LOCAL(8); // vector
+  _pf.LDINT();
+  _pf.LOCAL(-4);
+  _pf.STINT();
+
+  _pf.ALIGN();
+  _pf.LABEL(mklbl(cond = ++_lbl));
+  _pf.LOCAL(12); // values left
+  _pf.LDINT();
+  _pf.INT(0);
+  _pf.GT();
+  _pf.JZ(mklbl(end = ++_lbl));
+
+  if (doubles) {
+    _pf.CALL("readd");
+    _pf.LDFVAL64();
+    _pf.LOCAL(-4);
+    _pf.LDINT();
+    _pf.STDOUBLE();
+  } else {
+    _pf.CALL("readi");
+    _pf.LDFVAL32();
+    _pf.LOCAL(-4);
+    _pf.LDINT();
+    _pf.STINT();
+  }
+
+  _pf.LOCAL(-4);
+  _pf.LDINT();
+  _pf.INT(doubles ? 8 : 4);
+  _pf.ADD();
+  _pf.LOCAL(-4);
+  _pf.STINT();
+  _pf.LOCAL(12);
+  _pf.LDINT();
+  _pf.INT(1);
+  _pf.SUB();
+  _pf.LOCAL(12);
+  _pf.STINT();
+  _pf.JMP(mklbl(cond));
+
+  _pf.ALIGN();
+  _pf.LABEL(mklbl(end));
+  _pf.LOCAL(8);
+  _pf.LDINT();
+  _pf.STFVAL32();
+  _pf.LEAVE();
+  _pf.RET();
+}
+
+/** Helper ending the program when a buffer does not fit in the heap. */
+void til::postfix_writer::heap_exhausted() {
+  _pf.TEXT("_heap_exhausted");
+  _pf.ALIGN();
+  _pf.LABEL("_heap_exhausted");
+  _pf.ADDR(string_label("heap exhausted"));
+  _pf.CALL("prints");
+  _pf.TRASH(4);
+  _pf.CALL("println");
+  _pf.INT(1);
+  _pf.EXIT();
+}
+
+/** Helper computing (f ... (f (f initial v[low]) v[low + 1]) ... v[high - 1]), given (v, low, high, f, initial). */
+void til::postfix_writer::reduce_vector(const std::string &label, bool doubles) {
+  int cond, end;
+  int size = doubles ? 8 : 4;
+  int accumulator = -4 - size;
+  _pf.TEXT(label);
+  _pf.ALIGN();
+  _pf.LABEL(label);
+  _pf.ENTER(4 + size); // next index and value so far
+
+  _pf.LOCAL(12); // low
+  _pf.LDINT();
+  _pf.LOCAL(-4);
+  _pf.STINT();
+  _pf.LOCAL(24); // initial
+  if (doubles) {
+    _pf.LDDOUBLE();
+    _pf.LOCAL(accumulator);
+    _pf.STDOUBLE();
+  } else {
+    _pf.LDINT();
+    _pf.LOCAL(accumulator);
+    _pf.STINT();
+  }
+
+  _pf.ALIGN();
+  _pf.LABEL(mklbl(cond = ++_lbl));
+  _pf.LOCAL(-4);
+  _pf.LDINT();
+  _pf.LOCAL(16); // high
+  _pf.LDINT();
+  _pf.JGE(mklbl(end = ++_lbl));
+
+  // the element, then the value so far, are passed to the function
+  _pf.LOCAL(8); // vector
+  _pf.LDINT();
+  _pf.LOCAL(-4);
+  _pf.LDINT();
+  _pf.INT(size);
   _pf.MUL();
-  _pf.ALLOC();
-  _pf.SP();
+  _pf.ADD();
+  if (doubles) {
+    _pf.LDDOUBLE();
+    _pf.LOCAL(accumulator);
+    _pf.LDDOUBLE();
+  } else {
+    _pf.LDINT();
+    _pf.LOCAL(accumulator);
+    _pf.LDINT();
+  }
+  _pf.LOCAL(20); // function
+  _pf.LDINT();
+  _pf.BRANCH();
+  _pf.TRASH(2 * size);
+  if (doubles) {
+    _pf.LDFVAL64();
+    _pf.LOCAL(accumulator);
+    _pf.STDOUBLE();
+  } else {
+    _pf.LDFVAL32();
+    _pf.LOCAL(accumulator);
+    _pf.STINT();
+  }
+
+  _pf.LOCAL(-4);
+  _pf.LDINT();
+  _pf.INT(1);
+  _pf.ADD();
+  _pf.LOCAL(-4);
+  _pf.STINT();
+  _pf.JMP(mklbl(cond));
+
+  _pf.ALIGN();
+  _pf.LABEL(mklbl(end));
+  _pf.LOCAL(accumulator);
+  if (doubles) {
+    _pf.LDDOUBLE();
+    _pf.STFVAL64();
+  } else {
+    _pf.LDINT();
+    _pf.STFVAL32();
+  }
+  _pf.LEAVE();
+  _pf.RET();
+}
+
+/** Address of a field of the table entry for the argument: whether it is in use (0), the argument (4), the result (8). */
+void til::postfix_writer::memo_entry(int field) {
+  _pf.LOCAL(8);
+  _pf.LDINT();
+  _pf.INT(TIL_MEMO_ENTRIES - 1);
+  _pf.AND();
+  _pf.INT(4); // entries take 16 bytes
+  _pf.SHTL();
+  _pf.ADDR(*_memo);
+  _pf.ADD();
+  if (field > 0) {
+    _pf.INT(field);
+    _pf.ADD();
+  }
+}
+
+/** Store the result on top of the stack (leaving it there) in the table. */
+void til::postfix_writer::remember() {
+  _pf.DUP32();
+  memo_entry(8);
+  _pf.STINT();
+  _pf.LOCAL(8);
+  _pf.LDINT();
+  memo_entry(4);
+  _pf.STINT();
+  _pf.INT(1);
+  memo_entry(0);
+  _pf.STINT();
+}
+
+void til::postfix_writer::start_unit(cdk::basic_node * const unit) {
+  _constants = std::make_shared<constant_functions>(_compiler);
+  unit->accept(_constants.get(), 0);
+  _evaluator = std::make_shared<constant_evaluator>(_compiler, _constants);
+  if (_profiler) _profiler->PROFILE_UNIT();
+}
+
+void til::postfix_writer::finish_unit() {
+  if (_reads_ints) read_vector("_read_ints", false);
+  if (_reads_doubles) read_vector("_read_doubles", true);
+  if (_reduces_ints) reduce_vector("_reduce_ints", false);
+  if (_reduces_doubles) reduce_vector("_reduce_doubles", true);
+  if (_uses_heap) heap_exhausted();
+
+  if (!_strings.empty()) {
+    _pf.RODATA(); // strings are readonly DATA
+    _pf.ALIGN();
+    for (auto &literal : _strings) {
+      _pf.LABEL(literal.second);
+      _pf.SSTRING(literal.first);
+    }
+  }
+
+  for (auto &table : _memo_tables) {
+    _pf.BSS();
+    _pf.ALIGN();
+    _pf.LABEL(table);
+    _pf.SALLOC(TIL_MEMO_ENTRIES * 16);
+  }
+
+  if (!_uses_heap) return;
+
+  _pf.BSS();
+  _pf.ALIGN();
+  _pf.LABEL("_heap_base");
+  _pf.SALLOC(TIL_HEAP_SIZE);
+  _pf.LABEL("_heap_end");
+
+  _pf.DATA();
+  _pf.ALIGN();
+  _pf.LABEL("_heap_top");
+  _pf.SADDR("_heap_end");
 }
 
 //---------------------------------------------------------------------------
@@ -691,10 +1627,12 @@ void til::postfix_writer::loop_controller(T * const node) {
 }
 
 void til::postfix_writer::do_next_node(til::next_node * const node, int lvl) {
+  source_line(node);
   loop_controller<0>(node);
 }
 
 void til::postfix_writer::do_stop_node(til::stop_node * const node, int lvl) {
+  source_line(node);
   loop_controller<1>(node);
 }
 
@@ -703,6 +1641,10 @@ void til::postfix_writer::do_declaration_node(til::declaration_node * const node
   auto symbol = new_symbol();
   reset_new_symbol();
 
+  if (auto literal = dynamic_cast<til::function_definition_node*>(node->initializer())) {
+    _function_names.emplace(literal, node->identifier()); // names its profile record
+  }
+
   int offset = 0;
   int typesize = node->type()->size(); 
   if (_inFunctionArgs) {
@@ -720,7 +1662,10 @@ void til::postfix_writer::do_declaration_node(til::declaration_node * const node
     if (_inFunctionArgs || !node->initializer()) {
       return;
     }
+    source_line(node);
+    open_cse(node->initializer(), lvl);
     accept_covariant_node(node->type(), node->initializer(), lvl);
+    close_cse();
     if (node->is_typed(cdk::TYPE_DOUBLE)) {
       _pf.LOCAL(symbol->offset());
       _pf.STDOUBLE();
@@ -770,8 +1715,10 @@ void til::postfix_writer::do_declaration_node(til::declaration_node * const node
 
 void til::postfix_writer::do_with_node(til::with_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
 
   _symtab.push();
+  int loop_offset = _offset;
 
   auto low_name = std::string("_low"); 
   auto low_decl = new til::declaration_node(node->lineno(), tPRIVATE,
@@ -800,30 +1747,25 @@ void til::postfix_writer::do_with_node(til::with_node * const node, int lvl) {
   auto with_incr_assign = new cdk::assignment_node(node->lineno(), low, with_incr_sum);
   auto with_incr_eval = new til::evaluation_node(node->lineno(), with_incr_assign);
 
-  auto loop_cond = new cdk::lt_node(node->lineno(), low_rvalue, high_rvalue);
-
   auto loop_body = new cdk::sequence_node(node->lineno(), func_call_eval);
   loop_body = new cdk::sequence_node(node->lineno(), with_incr_eval, loop_body);
 
-  auto loop = new til::loop_node(node->lineno(), loop_cond, loop_body);
-
-  //auto if_instr = new til::if_node(node->lineno(), loop_cond, loop);
-  //if_instr->accept(this, lvl);
-
-  loop->accept(this, lvl);
+  counted_loop(low, high_rvalue, loop_body, true, lvl);
 
+  _offset = loop_offset;
   _symtab.pop();
 }
 
 void til::postfix_writer::do_unless_node(til::unless_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
 
   int endLabel;
   _pf.ALIGN();
-  node->condition()->accept(this, lvl);
-  _pf.JNZ(mklbl(endLabel = ++_lbl));
+  branch(node->condition(), true, mklbl(endLabel = ++_lbl), lvl);
 
-  _symtab.push(); 
+  _symtab.push();
+  int loop_offset = _offset;
 
   auto unless_name = std::string("_unless"); 
   auto unless_decl = new til::declaration_node(node->lineno(), tPRIVATE,
@@ -851,15 +1793,12 @@ void til::postfix_writer::do_unless_node(til::unless_node * const node, int lvl)
   auto unless_incr_assign = new cdk::assignment_node(node->lineno(), unless, unless_incr_sum);
   auto unless_incr_eval = new til::evaluation_node(node->lineno(), unless_incr_assign);
 
-  auto loop_cond = new cdk::lt_node(node->lineno(), unless_rvalue, count_rvalue);
-
   auto loop_body = new cdk::sequence_node(node->lineno(), func_call_eval);
   loop_body = new cdk::sequence_node(node->lineno(), unless_incr_eval, loop_body);
 
-  auto loop = new til::loop_node(node->lineno(), loop_cond, loop_body);
-
-  loop->accept(this, lvl);
+  counted_loop(unless, count_rvalue, loop_body, true, lvl);
 
+  _offset = loop_offset;
   _symtab.pop();
 
   _pf.ALIGN();
@@ -868,13 +1807,14 @@ void til::postfix_writer::do_unless_node(til::unless_node * const node, int lvl)
 
 void til::postfix_writer::do_sweep_node(til::sweep_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
 
   int endLabel;
   _pf.ALIGN();
-  node->condition()->accept(this, lvl);
-  _pf.JZ(mklbl(endLabel = ++_lbl));
+  branch(node->condition(), false, mklbl(endLabel = ++_lbl), lvl);
 
   _symtab.push();
+  int loop_offset = _offset;
 
   auto low_name = std::string("_low"); 
   auto low_decl = new til::declaration_node(node->lineno(), tPRIVATE,
@@ -894,12 +1834,12 @@ void til::postfix_writer::do_sweep_node(til::sweep_node * const node, int lvl) {
   auto with_incr_assign = new cdk::assignment_node(node->lineno(), low, with_incr_sum);
   auto with_incr_eval = new til::evaluation_node(node->lineno(), with_incr_assign);
 
-  auto loop_cond = new cdk::lt_node(node->lineno(), low_rvalue, node->high());
+  // the bound is evaluated for each element: only constants are safe to unroll
   auto loop_body = new cdk::sequence_node(node->lineno(), func_call_eval);
   loop_body = new cdk::sequence_node(node->lineno(), with_incr_eval, loop_body);
-  auto loop = new til::loop_node(node->lineno(), loop_cond, loop_body);
-  loop->accept(this, lvl);
+  counted_loop(low, node->high(), loop_body, isInstanceOf<cdk::integer_node>(node->high()), lvl);
 
+  _offset = loop_offset;
   _symtab.pop();
 
   _pf.ALIGN();
@@ -908,15 +1848,16 @@ void til::postfix_writer::do_sweep_node(til::sweep_node * const node, int lvl) {
 
 void til::postfix_writer::do_iterate_node(til::iterate_node * const node, int lvl) {
   ASSERT_SAFE_EXPRESSIONS;
+  source_line(node);
 
   int endLabel;
   auto lineno = node->lineno();
 
   _pf.ALIGN();
-  node->condition()->accept(this, lvl);
-  _pf.JZ(mklbl(endLabel = ++_lbl));
+  branch(node->condition(), false, mklbl(endLabel = ++_lbl), lvl);
 
   _symtab.push();
+  int loop_offset = _offset;
 
   auto iterate_name = std::string("_iterate");
   auto iterate_decl = new til::declaration_node(lineno, tPRIVATE,
@@ -935,14 +1876,36 @@ void til::postfix_writer::do_iterate_node(til::iterate_node * const node, int lv
   auto incr_assign = new cdk::assignment_node(lineno, iterate, incr_sum);
   auto incr_eval = new til::evaluation_node(lineno, incr_assign);
 
-  auto comparison = new cdk::lt_node(lineno, iterate_rvalue,  node->count());
   auto loop_body = new cdk::sequence_node(lineno, func_call_eval);
   loop_body = new cdk::sequence_node(lineno, incr_eval, loop_body);
-  auto loop = new til::loop_node(lineno, comparison, loop_body);
-  loop->accept(this, lvl);
+  counted_loop(iterate, node->count(), loop_body, isInstanceOf<cdk::integer_node>(node->count()), lvl);
   
+  _offset = loop_offset;
   _symtab.pop();
 
   _pf.ALIGN();
   _pf.LABEL(mklbl(endLabel));
+}
+
+void til::postfix_writer::do_reduce_node(til::reduce_node * const node, int lvl) {
+  ASSERT_SAFE_EXPRESSIONS;
+
+  // the unit's helper runs the loop (see reduce_vector)
+  bool doubles = node->is_typed(cdk::TYPE_DOUBLE);
+  accept_covariant_node(node->type(), node->initial(), lvl);
+  node->function()->accept(this, lvl);
+  node->high()->accept(this, lvl);
+  node->low()->accept(this, lvl);
+  node->vector()->accept(this, lvl);
+  if (doubles) {
+    _reduces_doubles = true;
+    _pf.CALL("_reduce_doubles");
+    _pf.TRASH(24);
+    _pf.LDFVAL64();
+  } else {
+    _reduces_ints = true;
+    _pf.CALL("_reduce_ints");
+    _pf.TRASH(20);
+    _pf.LDFVAL32();
+  }
 }
\ No newline at end of file
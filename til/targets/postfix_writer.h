@@ -2,13 +2,35 @@
 #define __SIMPLE_TARGETS_POSTFIX_WRITER_H__
 
 #include "targets/basic_ast_visitor.h"
+#include "targets/value_numbering.h"
+#include "targets/escape_analysis.h"
+#include "targets/constant_functions.h"
+#include "targets/constant_evaluator.h"
+#include "targets/memoization.h"
+#include "targets/postfix_sse2_emitter.h"
+#include "targets/postfix_profile_emitter.h"
 
 #include <sstream>
 #include <set>
 #include <stack>
 #include <optional>
+#include <map>
 #include <cdk/types/basic_type.h>
-#include <cdk/emitters/basic_postfix_emitter.h>
+
+// bytes reserved in each unit for buffers that cannot live in a stack frame
+#ifndef TIL_HEAP_SIZE
+#define TIL_HEAP_SIZE (64 * 1024 * 1024)
+#endif
+
+// largest constant-size buffer (in bytes) allocated in the stack frame
+#ifndef TIL_STACK_OBJECTS_LIMIT
+#define TIL_STACK_OBJECTS_LIMIT 1024
+#endif
+
+// elements visited per test by the loops of with, unless, sweep and iterate
+#ifndef TIL_UNROLL_FACTOR
+#define TIL_UNROLL_FACTOR 4
+#endif
 
 namespace til {
 
@@ -31,28 +53,111 @@ namespace til {
     std::string _current_func_ret_label; // where to jump when a return occurs of an exclusive section ends
 
     // code generation
-    cdk::basic_postfix_emitter &_pf;
+    postfix_sse2_emitter &_pf;
     int _lbl;
 
     std::vector<std::pair<std::string, std::string>> *_cur_func_loop_labels;
     bool _outside_func;
     bool _loop_ended; 
 
+    // common subexpression elimination (see value_numbering)
+    std::shared_ptr<value_numbering> _cse; // values of the statement being generated
+    std::map<std::string, int> _cse_slots; // frame offset holding each reused value
+    std::set<std::string> _cse_ready; // values already stored in their slots
+    int _cse_conditional; // > 0 while generating code that may not be executed
+    int _cse_offset; // frame offset before the statement's slots
+
+    // allocation of buffers (see escape_analysis)
+    std::shared_ptr<escape_analysis> _escapes; // allocations of the function being generated
+    std::optional<int> _heap_mark; // frame offset of the heap top at function entry (if released at exit)
+    bool _uses_heap; // whether the unit's heap must be emitted
+    bool _reads_ints, _reads_doubles; // whether the unit's vector reading helpers must be emitted
+    bool _reduces_ints, _reduces_doubles; // whether the unit's vector reduction helpers must be emitted
+    std::map<std::string, std::string> _strings; // label of each string literal of the unit
+    std::map<std::string, std::pair<std::string, std::string>> _wrappers; // label and target global of each covariant wrapper
+
+    // direct calls (see constant_functions)
+    std::shared_ptr<constant_functions> _constants; // globals always holding the same function
+    std::map<til::function_definition_node*, std::string> _literal_labels; // labels of function literals
+    std::set<til::function_definition_node*> _defined; // literals already generated (code may be repeated)
+    til::function_definition_node *_function; // function being generated (for its constant arguments)
+    std::shared_ptr<constant_evaluator> _evaluator; // calls computed at compile time
+
+    // results of pure recursive functions (see memoization)
+    std::optional<std::string> _memo; // table of the function being generated (if memoized)
+    std::vector<std::string> _memo_tables; // tables of the unit
+
+    // calls and cycles of each function (see postfix_profile_emitter)
+    postfix_profile_emitter *_profiler; // nullptr unless instrumenting
+    std::string _profile_record; // record of the function being generated
+    std::optional<int> _profile_slot; // frame offset of its clock
+    std::map<til::function_definition_node*, std::string> _function_names; // variables initialized with each literal
+
+    // debugging information (with --debug)
+    int _line; // source line of the code being generated (0 if none)
+    std::set<std::string> _symbols; // names given to functions
+
   public:
-    postfix_writer(std::shared_ptr<cdk::compiler> compiler, cdk::symbol_table<til::symbol> &symtab, cdk::basic_postfix_emitter &pf) :
+    postfix_writer(std::shared_ptr<cdk::compiler> compiler, cdk::symbol_table<til::symbol> &symtab, postfix_sse2_emitter &pf,
+                   postfix_profile_emitter *profiler = nullptr) :
         basic_ast_visitor(compiler), _symtab(symtab), _errors(false), _inFunctionArgs(false),_offset(0), _lvalueType(cdk::TYPE_VOID), 
-        _current_func_ret_label(""), _pf(pf), _lbl(0), _outside_func(false), _loop_ended(false) {
+        _current_func_ret_label(""), _pf(pf), _lbl(0), _outside_func(false), _loop_ended(false), _cse_conditional(0), _cse_offset(0), _uses_heap(false),
+        _reads_ints(false), _reads_doubles(false), _reduces_ints(false), _reduces_doubles(false), _function(nullptr),
+        _profiler(profiler), _line(0) {
     }
   public:
     ~postfix_writer() {
       os().flush();
     }
 
+  public:
+    /** Analyse the whole unit before generating it. */
+    void start_unit(cdk::basic_node * const unit);
+
+    /** Emit data shared by all the functions of the unit. */
+    void finish_unit();
+
   protected:
     void prepareIDBinaryExpression(cdk::binary_operation_node * const node, int lvl);
     void prepareIDBinaryComparisonExpression(cdk::binary_operation_node * const node, int lvl);
+    void test(cdk::expression_node * const condition, bool when, const std::string &target, int lvl);
+    void branch(cdk::expression_node * const condition, bool when, const std::string &target, int lvl);
+    std::string define_function(til::function_definition_node * const node, int lvl);
+    void function_address(const std::string &label);
+    std::string literal_label(til::function_definition_node * const node);
+    std::string string_label(const std::string &value);
+    std::string function_symbol(til::function_definition_node * const node);
+    void source_line(cdk::basic_node * const node);
+    void source_line(int line);
+    std::optional<std::string> direct_target(cdk::expression_node * const node);
+    std::optional<int> constant_call(til::function_call_node * const node);
+    cdk::expression_node *constant_parameter(cdk::rvalue_node * const node);
+    std::optional<int> constant_divisor(cdk::expression_node * const divisor);
+    std::optional<int> power_of_two(cdk::expression_node * const divisor);
+    void round_towards_zero(int k);
+    void divide_by_constant(int d);
     void accept_covariant_node(std::shared_ptr<cdk::basic_type> const node_type, cdk::expression_node * const node, int lvl);
     template<size_t P, typename T> void loop_controller(T * const node);
+    void counted_loop(cdk::variable_node * const counter, cdk::expression_node * const bound,
+                      cdk::sequence_node * const step, bool unroll, int lvl);
+    void print_text(const std::string &text, int lineno, int lvl);
+
+    void open_cse(cdk::basic_node * const node, int lvl);
+    void close_cse();
+    bool reuse_value(cdk::basic_node * const node, size_t size);
+    void keep_value(cdk::basic_node * const node, size_t size);
+    inline size_t value_size(cdk::typed_node * const node) {
+      return node->is_typed(cdk::TYPE_DOUBLE) ? 8 : 4;
+    }
+
+    bool stack_allocated(til::objects_node * const node);
+    void heap_allocate(size_t size);
+    void heap_exhausted();
+    void function_epilogue();
+    void memo_entry(int field);
+    void remember();
+    void read_vector(const std::string &label, bool doubles);
+    void reduce_vector(const std::string &label, bool doubles);
 
 
   private:
@@ -0,0 +1,4 @@
+#include "targets/profile_target.h"
+
+/** @var create and register a target for instrumented assembly. */
+til::profile_target til::profile_target::_self;
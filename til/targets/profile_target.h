@@ -0,0 +1,40 @@
+#ifndef __TIL_TARGETS_PROFILE_TARGET_H__
+#define __TIL_TARGETS_PROFILE_TARGET_H__
+
+#include <cdk/targets/basic_target.h>
+#include <cdk/ast/basic_node.h>
+#include "targets/postfix_writer.h"
+#include "targets/postfix_profile_emitter.h"
+
+namespace til {
+
+  //!
+  //! The assembly of the "asm" target, with every function counting its
+  //! calls and cycles (see postfix_profile_emitter).
+  //!
+  class profile_target: public cdk::basic_target {
+    static profile_target _self;
+
+  private:
+    profile_target() :
+        cdk::basic_target("profile") {
+    }
+
+  public:
+    bool evaluate(std::shared_ptr<cdk::compiler> compiler) {
+      cdk::symbol_table<til::symbol> symtab;
+      postfix_profile_emitter pf(compiler);
+
+      postfix_writer writer(compiler, symtab, pf, &pf);
+      writer.start_unit(compiler->ast());
+      compiler->ast()->accept(&writer, 0);
+      writer.finish_unit();
+
+      return true;
+    }
+
+  };
+
+} // til
+
+#endif
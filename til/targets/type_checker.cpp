@@ -367,7 +367,18 @@ void til::type_checker::do_print_node(til::print_node *const node, int lvl) {
 
 void til::type_checker::do_read_node(til::read_node *const node, int lvl) {
   ASSERT_UNSPEC;
-  node->type(cdk::primitive_type::create(0, cdk::TYPE_UNSPEC));
+  if (!node->count()) {
+    node->type(cdk::primitive_type::create(0, cdk::TYPE_UNSPEC));
+    return;
+  }
+
+  node->count()->accept(this, lvl + 2);
+  if (node->count()->is_typed(cdk::TYPE_UNSPEC)) {
+    node->count()->type(cdk::primitive_type::create(4, cdk::TYPE_INT));
+  } else if (!node->count()->is_typed(cdk::TYPE_INT)) {
+    throw std::string("wrong type in count of read expression");
+  }
+  node->type(cdk::reference_type::create(4, cdk::primitive_type::create(0, cdk::TYPE_UNSPEC)));
 }
 
 void til::type_checker::do_loop_node(til::loop_node * const node, int lvl) {
@@ -773,4 +784,50 @@ void til::type_checker::do_iterate_node(til::iterate_node *const node, int lvl)
   }
 
   throw std::string("wrong type for function in iterate instruction");
+}
+
+void til::type_checker::do_reduce_node(til::reduce_node *const node, int lvl) {
+  ASSERT_UNSPEC;
+
+  node->vector()->accept(this, lvl + 2);
+  if (!node->vector()->is_typed(cdk::TYPE_POINTER)) {
+    throw std::string("wrong type for vector in reduce expression");
+  }
+  auto element = cdk::reference_type::cast(node->vector()->type())->referenced();
+  if (element->name() != cdk::TYPE_INT && element->name() != cdk::TYPE_DOUBLE) {
+    throw std::string("wrong type for vector in reduce expression");
+  }
+
+  node->low()->accept(this, lvl + 2);
+  if (node->low()->is_typed(cdk::TYPE_UNSPEC)) {
+    node->low()->type(cdk::primitive_type::create(4, cdk::TYPE_INT));
+  } else if (!node->low()->is_typed(cdk::TYPE_INT)) {
+    throw std::string("wrong type for low in reduce expression");
+  }
+
+  node->high()->accept(this, lvl + 2);
+  if (node->high()->is_typed(cdk::TYPE_UNSPEC)) {
+    node->high()->type(cdk::primitive_type::create(4, cdk::TYPE_INT));
+  } else if (!node->high()->is_typed(cdk::TYPE_INT)) {
+    throw std::string("wrong type for high in reduce expression");
+  }
+
+  // the function combines the value so far with each element
+  node->function()->accept(this, lvl + 2);
+  auto functype = node->function()->is_typed(cdk::TYPE_FUNCTIONAL)
+      ? cdk::functional_type::cast(node->function()->type()) : nullptr;
+  if (!functype || functype->input_length() != 2 || functype->output(0)->name() != element->name()
+      || functype->input(0)->name() != element->name() || functype->input(1)->name() != element->name()) {
+    throw std::string("wrong type for function in reduce expression");
+  }
+
+  node->initial()->accept(this, lvl + 2);
+  if (node->initial()->is_typed(cdk::TYPE_UNSPEC)) {
+    node->initial()->type(element);
+  } else if (!node->initial()->is_typed(element->name())
+      && !(element->name() == cdk::TYPE_DOUBLE && node->initial()->is_typed(cdk::TYPE_INT))) {
+    throw std::string("wrong type for initial value in reduce expression");
+  }
+
+  node->type(element);
 }
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <string>
+#include <sstream>
+#include "targets/value_numbering.h"
+#include ".auto/all_nodes.h"  // automatically generated
+
+std::vector<std::string> til::value_numbering::repeated() const {
+  std::vector<std::string> values;
+  if (!_pure) return values;
+  for (auto &value : _order) {
+    if (_occurrences.at(value) > 1) values.push_back(value);
+  }
+  return values;
+}
+
+std::optional<std::string> til::value_numbering::repeated(cdk::basic_node *node) const {
+  auto it = _values.find(node);
+  if (!_pure || it == _values.end() || _occurrences.at(it->second) < 2) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void til::value_numbering::number(cdk::basic_node *node, const std::string &value) {
+  if (_occurrences[value]++ == 0) _order.push_back(value);
+  _values[node] = value;
+  _value = value;
+}
+
+void til::value_numbering::do_impure(cdk::basic_node *const node) {
+  _pure = false;
+  _value.clear();
+}
+
+//---------------------------------------------------------------------------
+
+void til::value_numbering::do_nil_node(cdk::nil_node *const node, int lvl) {
+  _value.clear();
+}
+void til::value_numbering::do_data_node(cdk::data_node *const node, int lvl) {
+  _value.clear();
+}
+
+void til::value_numbering::do_sequence_node(cdk::sequence_node *const node, int lvl) {
+  for (size_t i = 0; i < node->size(); i++) {
+    node->node(i)->accept(this, lvl);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void til::value_numbering::do_integer_node(cdk::integer_node *const node, int lvl) {
+  _value = "i" + std::to_string(node->value());
+}
+
+void til::value_numbering::do_double_node(cdk::double_node *const node, int lvl) {
+  std::ostringstream oss;
+  oss << "d" << std::hexfloat << node->value();
+  _value = oss.str();
+}
+
+void til::value_numbering::do_string_node(cdk::string_node *const node, int lvl) {
+  _value.clear(); // each literal has its own label
+}
+
+void til::value_numbering::do_null_node(til::null_node *const node, int lvl) {
+  _value = "i0";
+}
+
+//---------------------------------------------------------------------------
+
+void til::value_numbering::do_unary_operation(cdk::unary_operation_node *const node, const std::string &op) {
+  node->argument()->accept(this, 0);
+  if (!_value.empty()) number(node, op + "(" + _value + ")");
+}
+
+void til::value_numbering::do_unary_minus_node(cdk::unary_minus_node *const node, int lvl) {
+  do_unary_operation(node, "-");
+}
+void til::value_numbering::do_unary_plus_node(cdk::unary_plus_node *const node, int lvl) {
+  node->argument()->accept(this, lvl); // same value as the argument
+}
+void til::value_numbering::do_not_node(cdk::not_node *const node, int lvl) {
+  do_unary_operation(node, "~");
+}
+
+//---------------------------------------------------------------------------
+
+void til::value_numbering::do_binary_operation(cdk::binary_operation_node *const node, const std::string &op) {
+  node->left()->accept(this, 0);
+  auto left = _value;
+  node->right()->accept(this, 0);
+  auto right = _value;
+
+  if (left.empty() || right.empty()) {
+    _value.clear();
+  } else {
+    number(node, op + "(" + left + "," + right + ")");
+  }
+}
+
+void til::value_numbering::do_add_node(cdk::add_node *const node, int lvl) {
+  do_binary_operation(node, "+");
+}
+void til::value_numbering::do_sub_node(cdk::sub_node *const node, int lvl) {
+  do_binary_operation(node, "-");
+}
+void til::value_numbering::do_mul_node(cdk::mul_node *const node, int lvl) {
+  do_binary_operation(node, "*");
+}
+void til::value_numbering::do_div_node(cdk::div_node *const node, int lvl) {
+  do_binary_operation(node, "/");
+}
+void til::value_numbering::do_mod_node(cdk::mod_node *const node, int lvl) {
+  do_binary_operation(node, "%");
+}
+void til::value_numbering::do_lt_node(cdk::lt_node *const node, int lvl) {
+  do_binary_operation(node, "<");
+}
+void til::value_numbering::do_le_node(cdk::le_node *const node, int lvl) {
+  do_binary_operation(node, "<=");
+}
+void til::value_numbering::do_ge_node(cdk::ge_node *const node, int lvl) {
+  do_binary_operation(node, ">=");
+}
+void til::value_numbering::do_gt_node(cdk::gt_node *const node, int lvl) {
+  do_binary_operation(node, ">");
+}
+void til::value_numbering::do_ne_node(cdk::ne_node *const node, int lvl) {
+  do_binary_operation(node, "!=");
+}
+void til::value_numbering::do_eq_node(cdk::eq_node *const node, int lvl) {
+  do_binary_operation(node, "==");
+}
+void til::value_numbering::do_and_node(cdk::and_node *const node, int lvl) {
+  do_binary_operation(node, "&&");
+}
+void til::value_numbering::do_or_node(cdk::or_node *const node, int lvl) {
+  do_binary_operation(node, "||");
+}
+
+//---------------------------------------------------------------------------
+
+void til::value_numbering::do_variable_node(cdk::variable_node *const node, int lvl) {
+  _value = "&" + node->name(); // loading a variable is as cheap as loading a temporary
+}
+
+void til::value_numbering::do_index_node(til::index_node *const node, int lvl) {
+  node->base()->accept(this, lvl);
+  auto base = _value;
+  node->index()->accept(this, lvl);
+  auto index = _value;
+
+  if (base.empty() || index.empty()) {
+    _value.clear();
+  } else {
+    number(node, "&[" + base + "," + index + "]");
+  }
+}
+
+void til::value_numbering::do_rvalue_node(cdk::rvalue_node *const node, int lvl) {
+  node->lvalue()->accept(this, lvl);
+  if (_value.empty()) return;
+
+  if (dynamic_cast<til::index_node*>(node->lvalue())) {
+    number(node, "*" + _value);
+  } else {
+    _value = "*" + _value;
+  }
+}
+
+void til::value_numbering::do_address_of_node(til::address_of_node *const node, int lvl) {
+  node->lvalue()->accept(this, lvl); // same value as the lvalue's address
+}
+
+void til::value_numbering::do_sizeof_node(til::sizeof_node *const node, int lvl) {
+  _value.clear(); // the expression is not evaluated
+}
+
+//---------------------------------------------------------------------------
+
+void til::value_numbering::do_evaluation_node(til::evaluation_node *const node, int lvl) {
+  // the statement's own assignment stores after everything else is computed
+  if (auto assignment = dynamic_cast<cdk::assignment_node*>(node->argument())) {
+    assignment->rvalue()->accept(this, lvl);
+    assignment->lvalue()->accept(this, lvl);
+  } else {
+    node->argument()->accept(this, lvl);
+  }
+}
+
+void til::value_numbering::do_print_node(til::print_node *const node, int lvl) {
+  node->expressions()->accept(this, lvl);
+}
+
+void til::value_numbering::do_return_node(til::return_node *const node, int lvl) {
+  if (node->retval()) node->retval()->accept(this, lvl);
+}
+
+//---------------------------------------------------------------------------
+
+void til::value_numbering::do_assignment_node(cdk::assignment_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_read_node(til::read_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_objects_node(til::objects_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_function_call_node(til::function_call_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_function_definition_node(til::function_definition_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_declaration_node(til::declaration_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_block_node(til::block_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_if_node(til::if_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_if_else_node(til::if_else_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_loop_node(til::loop_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_next_node(til::next_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_stop_node(til::stop_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_with_node(til::with_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_unless_node(til::unless_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_sweep_node(til::sweep_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_iterate_node(til::iterate_node *const node, int lvl) {
+  do_impure(node);
+}
+void til::value_numbering::do_reduce_node(til::reduce_node *const node, int lvl) {
+  do_impure(node);
+}
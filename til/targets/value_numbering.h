@@ -0,0 +1,66 @@
+#ifndef __TIL_TARGETS_VALUE_NUMBERING_H__
+#define __TIL_TARGETS_VALUE_NUMBERING_H__
+
+#include "targets/basic_ast_visitor.h"
+
+#include <map>
+#include <vector>
+#include <optional>
+
+namespace til {
+
+  //!
+  //! Number the values computed by a single statement (or the condition of
+  //! an if or loop, or the initializer of a local), so that the code
+  //! generator can compute repeated subexpressions once and reuse them.
+  //!
+  //! Only statements without stores, calls, allocations or input are
+  //! numbered: within them, equal expressions always produce equal values.
+  //! A statement that is itself an assignment is numbered too, as its store
+  //! is the last thing it does.
+  //!
+  class value_numbering: public basic_ast_visitor {
+    std::map<std::string, size_t> _occurrences; // times each value is computed
+    std::map<cdk::basic_node*, std::string> _values; // value of each reusable node
+    std::vector<std::string> _order; // values in order of first occurrence
+    std::string _value; // value of the last visited expression (empty if opaque)
+    bool _pure;
+
+  public:
+    value_numbering(std::shared_ptr<cdk::compiler> compiler) :
+        basic_ast_visitor(compiler), _pure(true) {
+    }
+
+  public:
+    ~value_numbering() {
+    }
+
+  public:
+    bool pure() const {
+      return _pure;
+    }
+
+    /** Values computed more than once, in order of first occurrence. */
+    std::vector<std::string> repeated() const;
+
+    /** Value computed by the node, if it is computed more than once. */
+    std::optional<std::string> repeated(cdk::basic_node *node) const;
+
+  protected:
+    void number(cdk::basic_node *node, const std::string &value);
+    void do_unary_operation(cdk::unary_operation_node *const node, const std::string &op);
+    void do_binary_operation(cdk::binary_operation_node *const node, const std::string &op);
+    void do_impure(cdk::basic_node *const node);
+
+  public:
+  // do not edit these lines
+#define __IN_VISITOR_HEADER__
+#include ".auto/visitor_decls.h"       // automatically generated
+#undef __IN_VISITOR_HEADER__
+  // do not edit these lines: end
+
+  };
+
+} // til
+
+#endif
@@ -15,7 +15,8 @@ void til::xml_writer::do_data_node(cdk::data_node * const node, int lvl) {
 //---------------------------------------------------------------------------
 
 void til::xml_writer::do_sequence_node(cdk::sequence_node * const node, int lvl) {
-  os() << std::string(lvl, ' ') << "<sequence_node size='" << node->size() << "'>" << std::endl;
+  indent(lvl);
+  os() << "<sequence_node size='" << node->size() << "'>\n";
   for (size_t i = 0; i < node->size(); i++)
     node->node(i)->accept(this, lvl + 2);
   closeTag(node, lvl);
@@ -38,7 +39,6 @@ void til::xml_writer::do_double_node(cdk::double_node * const node, int lvl) {
 //---------------------------------------------------------------------------
 
 void til::xml_writer::do_unary_operation(cdk::unary_operation_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   openTag(node, lvl);
   node->argument()->accept(this, lvl + 2);
   closeTag(node, lvl);
@@ -60,7 +60,6 @@ void til::xml_writer::do_objects_node(til::objects_node * const node, int lvl) {
 //---------------------------------------------------------------------------
 
 void til::xml_writer::do_binary_operation(cdk::binary_operation_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   openTag(node, lvl);
   node->left()->accept(this, lvl + 2);
   node->right()->accept(this, lvl + 2);
@@ -110,19 +109,19 @@ void til::xml_writer::do_or_node(cdk::or_node * const node, int lvl) {
 //---------------------------------------------------------------------------
 
 void til::xml_writer::do_variable_node(cdk::variable_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
-  os() << std::string(lvl, ' ') << "<" << node->label() << ">" << node->name() << "</" << node->label() << ">" << std::endl;
+  indent(lvl);
+  os() << "<" << node->label() << ">";
+  value(node->name());
+  os() << "</" << node->label() << ">\n";
 }
 
 void til::xml_writer::do_rvalue_node(cdk::rvalue_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   openTag(node, lvl);
   node->lvalue()->accept(this, lvl + 2);
   closeTag(node, lvl);
 }
 
 void til::xml_writer::do_assignment_node(cdk::assignment_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   openTag(node, lvl);
   openTag("left", lvl + 2);
   node->lvalue()->accept(this, lvl + 4);
@@ -135,8 +134,6 @@ void til::xml_writer::do_assignment_node(cdk::assignment_node * const node, int
 }
 
 void til::xml_writer::do_index_node(til::index_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
-
   openTag(node, lvl);
   openTag("base", lvl + 2);
   node->base()->accept(this, lvl + 4);
@@ -150,8 +147,6 @@ void til::xml_writer::do_index_node(til::index_node * const node, int lvl) {
 //---------------------------------------------------------------------------
 
 void til::xml_writer::do_address_of_node(til::address_of_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
-
   openTag(node, lvl);
   node->lvalue()->accept(this, lvl + 2);
   closeTag(node, lvl);
@@ -161,7 +156,6 @@ void til::xml_writer::do_address_of_node(til::address_of_node * const node, int
 
 
 void til::xml_writer::do_function_call_node(til::function_call_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   openTag(node, lvl);
   openTag("func", lvl + 2);
   if (node->func() == nullptr) {
@@ -213,8 +207,13 @@ void til::xml_writer::do_print_node(til::print_node * const node, int lvl) {
 //---------------------------------------------------------------------------
 
 void til::xml_writer::do_read_node(til::read_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
-  emptyTag(node, lvl);
+  if (!node->count()) {
+    emptyTag(node, lvl);
+    return;
+  }
+  openTag(node, lvl);
+  node->count()->accept(this, lvl + 2);
+  closeTag(node, lvl);
 }
 
 //---------------------------------------------------------------------------
@@ -247,7 +246,6 @@ void til::xml_writer::do_if_else_node(til::if_else_node * const node, int lvl) {
 }
 
 void til::xml_writer::do_block_node(til::block_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   openTag(node, lvl);
   openTag("declarations", lvl + 2);
   node->declarations()->accept(this, lvl + 4);
@@ -271,12 +269,10 @@ void til::xml_writer::do_loop_node(til::loop_node * const node, int lvl) {
 }
 
 void til::xml_writer::do_next_node(til::next_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   emptyTagWithAttributes(node, lvl, std::make_pair("level", node->level()));
 }
 
 void til::xml_writer::do_null_node(til::null_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   emptyTag(node, lvl);
 }
 
@@ -292,14 +288,12 @@ void til::xml_writer::do_return_node(til::return_node * const node, int lvl) {
 }
 
 void til::xml_writer::do_sizeof_node(til::sizeof_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   openTag(node, lvl);
   node->expression()->accept(this, lvl + 2);
   closeTag(node, lvl);
 }
 
 void til::xml_writer::do_stop_node(til::stop_node * const node, int lvl) {
-  ASSERT_SAFE_EXPRESSIONS;
   emptyTagWithAttributes(node, lvl, std::make_pair("level", node->level()));
 }
 
@@ -350,4 +344,24 @@ void til::xml_writer::do_iterate_node(til::iterate_node * const node, int lvl) {
   openTag(node, lvl);
   // TODO
   closeTag(node, lvl);
+}
+
+void til::xml_writer::do_reduce_node(til::reduce_node * const node, int lvl) {
+  openTag(node, lvl);
+  openTag("vector", lvl + 2);
+  node->vector()->accept(this, lvl + 4);
+  closeTag("vector", lvl + 2);
+  openTag("low", lvl + 2);
+  node->low()->accept(this, lvl + 4);
+  closeTag("low", lvl + 2);
+  openTag("high", lvl + 2);
+  node->high()->accept(this, lvl + 4);
+  closeTag("high", lvl + 2);
+  openTag("function", lvl + 2);
+  node->function()->accept(this, lvl + 4);
+  closeTag("function", lvl + 2);
+  openTag("initial", lvl + 2);
+  node->initial()->accept(this, lvl + 4);
+  closeTag("initial", lvl + 2);
+  closeTag(node, lvl);
 }
\ No newline at end of file
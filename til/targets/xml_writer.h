@@ -26,25 +26,63 @@ namespace til {
     }
 
   private:
+    // output is indented, but never flushed, one line at a time
+    void indent(int lvl) {
+      static const std::string spaces(128, ' ');
+      for (; lvl > static_cast<int>(spaces.size()); lvl -= spaces.size()) {
+        os().write(spaces.data(), spaces.size());
+      }
+      os().write(spaces.data(), lvl);
+    }
+    // only what XML requires, so that other text is written as before
+    void escape(const std::string &text) {
+      size_t plain = 0; // start of the characters not yet written
+      for (size_t i = 0; i < text.size(); i++) {
+        const char *entity;
+        switch (text[i]) {
+          case '&': entity = "&amp;"; break;
+          case '<': entity = "&lt;"; break;
+          default: continue;
+        }
+        os().write(text.data() + plain, i - plain);
+        os() << entity;
+        plain = i + 1;
+      }
+      os().write(text.data() + plain, text.size() - plain);
+    }
+    template<typename T>
+    void value(const T &value) {
+      os() << value;
+    }
+    void value(const std::string &value) {
+      escape(value);
+    }
+    void value(const char *value) {
+      escape(value);
+    }
+
     void openTag(const std::string &tag, int lvl) {
-      os() << std::string(lvl, ' ') + "<" + tag + ">" << std::endl;
+      indent(lvl);
+      os() << "<" << tag << ">\n";
     }
     void openTag(const cdk::basic_node *node, int lvl) {
       openTag(node->label(), lvl);
     }
     void closeTag(const std::string &tag, int lvl) {
-      os() << std::string(lvl, ' ') + "</" + tag + ">" << std::endl;
+      indent(lvl);
+      os() << "</" << tag << ">\n";
     }
     void closeTag(const cdk::basic_node *node, int lvl) {
       closeTag(node->label(), lvl);
     }
     template<class... Attributes>
     void openTagWithAttributes(const std::string &tag, int lvl, bool empty, Attributes&&... attrs) {
-      os() << std::string(lvl, ' ') + "<" + tag;
+      indent(lvl);
+      os() << "<" << tag;
 
-      ((os() << " " << std::get<0>(attrs) << "=\"" << std::get<1>(attrs) << "\""), ...);
+      ((os() << " " << std::get<0>(attrs) << "=\"", value(std::get<1>(attrs)), os() << "\""), ...);
 
-      os() << (empty ? " />" : ">") << std::endl;
+      os() << (empty ? " />\n" : ">\n");
     }
     /*
      * Allow passing attributes to the opening tag.
@@ -59,7 +97,8 @@ namespace til {
       openTagWithAttributes(node->label(), lvl, true, attrs...);
     }
     void emptyTag(const std::string &tag, int lvl) {
-      os() << std::string(lvl, ' ') + "<" + tag + " />" << std::endl;
+      indent(lvl);
+      os() << "<" << tag << " />\n";
     }
     void emptyTag(const cdk::basic_node *node, int lvl) {
       emptyTag(node->label(), lvl);
@@ -70,7 +109,10 @@ namespace til {
     void do_unary_operation(cdk::unary_operation_node *const node, int lvl);
     template<typename T>
     void process_literal(cdk::literal_node<T> *const node, int lvl) {
-      os() << std::string(lvl, ' ') << "<" << node->label() << ">" << node->value() << "</" << node->label() << ">" << std::endl;
+      indent(lvl);
+      os() << "<" << node->label() << ">";
+      value(node->value());
+      os() << "</" << node->label() << ">\n";
     }
     inline const char *bool_to_str(bool boolean) {
       return boolean ? "true" : "false";
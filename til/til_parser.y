@@ -40,7 +40,7 @@
 %token <s> tIDENTIFIER tSTRING
 %token tTYPE_INT tTYPE_DOUBLE tTYPE_STRING tTYPE_VOID
 %token tEXTERNAL tFORWARD tPUBLIC tPRIVATE tVAR
-%token tLOOP tRETURN tNEXT tSTOP tWITH tUNLESS tSWEEP tITERATE tCOUNT
+%token tLOOP tRETURN tNEXT tSTOP tWITH tUNLESS tSWEEP tITERATE tREDUCE tCOUNT
 %token tIF tBLOCK
 %token tREAD tNULL tSIZEOF tOBJECTS tINDEX
 %token tPROGRAM tFUNCTION
@@ -183,10 +183,12 @@ expr : tINTEGER                       { $$ = new cdk::integer_node(LINE, $1); }
      | '(' tOR expr expr ')'          { $$ = new cdk::or_node(LINE, $3, $4); }
      | '(' tOBJECTS expr ')'          { $$ = new til::objects_node(LINE, $3); }
      | '(' tSIZEOF expr ')'           { $$ = new til::sizeof_node(LINE, $3); }
+     | '(' tREDUCE expr expr expr expr expr ')' { $$ = new til::reduce_node(LINE, $3, $4, $5, $6, $7); }
      | lval                           { $$ = new cdk::rvalue_node(LINE, $1); }
      | '(' tSET lval expr ')'         { $$ = new cdk::assignment_node(LINE, $3, $4); }
      | '(' '?' lval ')'               { $$ = new til::address_of_node(LINE, $3); }
      | '(' tREAD ')'                  { $$ = new til::read_node(LINE); }
+     | '(' tREAD expr ')'             { $$ = new til::read_node(LINE, $3); }
      | '(' expr exprs ')'             { $$ = new til::function_call_node(LINE, $2, $3); }
      | '(' expr ')'                   { $$ = new til::function_call_node(LINE, $2, new cdk::sequence_node(LINE)); }
      | '(' '@' exprs ')'              { $$ = new til::function_call_node(LINE, nullptr, $3); }